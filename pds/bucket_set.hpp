@@ -0,0 +1,162 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <iostream>
+#include <cstdint>
+#include <cstddef>
+
+namespace pds {
+
+    using Indices = std::vector<std::vector<size_t>>;
+
+    //
+    // bucket layout: the (sorted) hot buckets of each row, as returned by
+    // sketch::indexes(), and the offset of each row in a bucket_set (in words).
+    //
+
+    struct bucket_layout
+    {
+        bucket_layout(Indices h)
+        : hot(std::move(h))
+        , offset(1, 0)
+        {
+            for(auto const & row : hot)
+                offset.push_back(offset.back() + (row.size() + 63)/64);
+        }
+
+        Indices hot;
+        std::vector<size_t> offset;
+    };
+
+    //
+    // bucket set: for each row, the subset of the hot buckets as a bitmap
+    // over their positions in the layout. All the rows are stored in a single
+    // buffer: intersections are plain word-wise ANDs and a row is empty when
+    // the OR of its words is zero (popcount is only needed by count()).
+    //
+
+    struct bucket_set
+    {
+        bucket_set() = default;
+
+        explicit bucket_set(std::shared_ptr<const bucket_layout> l)
+        : layout(std::move(l))
+        , bits(layout->offset.back(), 0)
+        { }
+
+        void set(size_t row, size_t pos)
+        {
+            bits[layout->offset[row] + pos/64] |= (1ULL << (pos & 63));
+        }
+
+        bool test(size_t row, size_t pos) const
+        {
+            return bits[layout->offset[row] + pos/64] & (1ULL << (pos & 63));
+        }
+
+        size_t rows() const
+        {
+            return layout->hot.size();
+        }
+
+        size_t count(size_t row) const
+        {
+            size_t n = 0;
+            for(auto i = layout->offset[row]; i < layout->offset[row+1]; ++i)
+                n += static_cast<size_t>(__builtin_popcountll(bits[i]));
+            return n;
+        }
+
+        bool empty(size_t row) const
+        {
+            for(auto i = layout->offset[row]; i < layout->offset[row+1]; ++i)
+                if (bits[i])
+                    return false;
+            return true;
+        }
+
+        //
+        // back to the indexes of the buckets
+        //
+
+        Indices
+        to_indices() const
+        {
+            Indices ret;
+
+            for(size_t r = 0; r < rows(); ++r)
+            {
+                std::vector<size_t> row;
+                auto const & hot = layout->hot[r];
+
+                for(size_t p = 0; p < hot.size(); ++p)
+                    if (test(r, p))
+                        row.push_back(hot[p]);
+
+                ret.push_back(std::move(row));
+            }
+
+            return ret;
+        }
+
+        std::shared_ptr<const bucket_layout> layout;
+        std::vector<uint64_t> bits;
+    };
+
+
+    inline bool
+    operator==(bucket_set const &lhs, bucket_set const &rhs)
+    {
+        return lhs.bits == rhs.bits;
+    }
+
+    inline bool
+    operator!=(bucket_set const &lhs, bucket_set const &rhs)
+    {
+        return !(lhs == rhs);
+    }
+
+
+    template <typename CharT, typename Traits>
+    typename std::basic_ostream<CharT, Traits> &
+    operator<<(std::basic_ostream<CharT,Traits>& out, bucket_set const& s)
+    {
+        out << "[";
+        for(auto const & i : s.to_indices())
+        {
+            out << "[";
+            for(auto j : i)
+                out << j << ' ';
+            out << "]";
+        }
+        return out << "]";
+    }
+
+} // namespace pds
@@ -29,6 +29,7 @@
 #include <pds/tuple.hpp>
 
 #include <vector>
+#include <array>
 #include <algorithm>
 
 
@@ -133,5 +134,144 @@ namespace pds {
                }, vs);
     }
 
+    //
+    // lazy expansion: depth-first join of the vectors. A partial tuple is
+    // dropped as soon as the filter returns nullopt, and every complete one
+    // is passed to the yield callback in the same order as
+    // expand_cartesian_product_by(), with no intermediate vector.
+    //
+
+    namespace details
+    {
+        template <size_t I, typename Filt, typename Fun, typename Acc, typename ...Ts>
+        inline std::enable_if_t<I == sizeof...(Ts)>
+        join_by(std::tuple<std::vector<Ts>...> const &, Filt &, Fun &yield, Acc const &acc)
+        {
+            yield(acc);
+        }
+
+        template <size_t I, typename Filt, typename Fun, typename Acc, typename ...Ts>
+        inline std::enable_if_t<(I < sizeof...(Ts))>
+        join_by(std::tuple<std::vector<Ts>...> const &vs, Filt &filter, Fun &yield, Acc const &acc)
+        {
+            for(auto &e : std::get<I>(vs))
+                if (auto x = filter(acc, e))
+                    join_by<I+1>(vs, filter, yield, *x);
+        }
+
+        //
+        // as join_by, restricted to the tuples of the first depth vectors whose
+        // (row-major) index is in [begin, end). base is the index of acc.
+        //
+
+        template <size_t I, typename Filt, typename Fun, typename Acc, typename ...Ts>
+        inline std::enable_if_t<I == sizeof...(Ts)>
+        join_range_by(std::tuple<std::vector<Ts>...> const &, Filt &, Fun &yield, Acc const &acc,
+                      size_t const *, size_t, size_t, size_t, size_t)
+        {
+            yield(acc);
+        }
+
+        template <size_t I, typename Filt, typename Fun, typename Acc, typename ...Ts>
+        inline std::enable_if_t<(I < sizeof...(Ts))>
+        join_range_by(std::tuple<std::vector<Ts>...> const &vs, Filt &filter, Fun &yield, Acc const &acc,
+                      size_t const *stride, size_t depth, size_t base, size_t begin, size_t end)
+        {
+            if (I >= depth)
+                return join_by<I>(vs, filter, yield, acc);
+
+            for(auto &e : std::get<I>(vs))
+            {
+                if (base >= end)
+                    return;
+
+                if (base + stride[I] > begin)
+                    if (auto x = filter(acc, e))
+                        join_range_by<I+1>(vs, filter, yield, *x, stride, depth, base, begin, end);
+
+                base += stride[I];
+            }
+        }
+
+        template <typename ...Ts, size_t ...N>
+        std::array<size_t, sizeof...(Ts)>
+        sizes_of(std::tuple<std::vector<Ts>...> const &vs, std::index_sequence<N...>)
+        {
+            return {{ std::get<N>(vs).size()... }};
+        }
+
+        template <typename Filt, typename Acc, typename ...Ts>
+        struct join_type
+        {
+            using type = Acc;
+        };
+
+        template <typename Filt, typename Acc, typename T, typename ...Ts>
+        struct join_type<Filt, Acc, T, Ts...>
+        : join_type<Filt, std::decay_t<decltype(*(std::declval<Filt &>()(std::declval<Acc>(), std::declval<T>())))>, Ts...>
+        { };
+
+    } // namespace details
+
+    //
+    // type of the tuples yielded by the expansion of vs with filter
+    //
+
+    template <typename Filt, typename Tup>
+    struct cartesian_product_type;
+
+    template <typename Filt, typename T, typename ...Ts>
+    struct cartesian_product_type<Filt, std::tuple<std::vector<T>, std::vector<Ts>...>>
+    : details::join_type<Filt, T, Ts...>
+    { };
+
+    template <typename Filt, typename Tup>
+    using cartesian_product_type_t = typename cartesian_product_type<Filt, Tup>::type;
+
+    //
+    // the range [begin, end) of the product of the first depth vectors (by
+    // default the first vector alone) is expanded, in row-major order.
+    //
+
+    template <typename Filt, typename Fun, typename T, typename ...Ts>
+    void foreach_cartesian_product_by(std::tuple<std::vector<T>, std::vector<Ts>...> const &vs, Filt filter, Fun yield,
+                                      size_t begin = 0, size_t end = static_cast<size_t>(-1), size_t depth = 1)
+    {
+        auto sizes = details::sizes_of(vs, std::make_index_sequence<1 + sizeof...(Ts)>{});
+
+        depth = std::min(std::max<size_t>(depth, 1), sizes.size());
+
+        std::array<size_t, 1 + sizeof...(Ts)> stride;
+        size_t s = 1;
+        for(auto i = depth; i-- > 0; )
+        {
+            stride[i] = s;
+            s *= sizes[i];
+        }
+
+        auto const & v0 = std::get<0>(vs);
+
+        for(size_t i = 0, base = 0; i < v0.size() && base < end; ++i, base += stride[0])
+        {
+            if (base + stride[0] > begin)
+                details::join_range_by<1>(vs, filter, yield, v0[i], stride.data(), depth, base, begin, end);
+        }
+    }
+
+    //
+    // number of tuples in the product of the first depth vectors
+    //
+
+    template <typename ...Ts>
+    size_t cartesian_prefix_size(std::tuple<std::vector<Ts>...> const &vs, size_t depth)
+    {
+        auto sizes = details::sizes_of(vs, std::make_index_sequence<sizeof...(Ts)>{});
+
+        size_t s = 1;
+        for(size_t i = 0; i < std::min(depth, sizes.size()); ++i)
+            s *= sizes[i];
+        return s;
+    }
+
 
 } // pds
@@ -0,0 +1,208 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+#include <pds/hash.hpp>
+
+#include <array>
+#include <algorithm>
+#include <type_traits>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Count-Sketch:
+    //
+    // Charikar, Chen, Farach-Colton (2002). "Finding Frequent Items in Data Streams". ICALP 2002.
+    //
+    // each row adds the update to the bucket of the element multiplied by a
+    // +/-1 sign, drawn from a per-row seeded 64-bit hash of the element. The
+    // estimate is the median of the signed buckets across rows, unbiased
+    // (unlike count-min). The sum of the squared buckets of a row estimates
+    // F2 (Alon, Matias, Szegedy); the row-wise product of two sketches sharing
+    // the hash functions estimates the size of the join of their streams.
+    //
+    // The sketch is inherited privately: the count-min interface (unsigned
+    // updates, minsum, indexes, reversing...) does not hold for signed buckets.
+    //
+
+    template <typename T, std::size_t W, typename ...Hs>
+    struct count_sketch : private sketch<T, W, Hs...>
+    {
+        static_assert(std::is_signed<T>::value, "count_sketch: counters must be of signed type!");
+
+        using base_type = sketch<T, W, Hs...>;
+
+        using base_type::size;
+        using base_type::reset;
+
+        template <typename ...Xs>
+        count_sketch(Xs ... xs)
+        : base_type(xs...)
+        { }
+
+        //
+        // access to the bucket (row, column)
+        //
+
+        T & at(size_t r, size_t c)
+        {
+            return base_type::operator()(r, c);
+        }
+
+        T const & at(size_t r, size_t c) const
+        {
+            return base_type::operator()(r, c);
+        }
+
+        //
+        // the sign of the element in the given row
+        //
+
+        template <typename Tp>
+        static int sign(size_t row, Tp const &elem)
+        {
+            return (hash64(elem, 0x9e3779b97f4a7c15ULL * (row + 1)) >> 63) ? -1 : 1;
+        }
+
+        //
+        // increment/decrement buckets
+        //
+
+        template <typename Tp>
+        void increment_buckets(Tp const &elem, T value = 1)
+        {
+            auto idx = this->bucket_indexes(elem);
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+                this->data_[r][idx[r]] += sign(r, elem) * value;
+        }
+
+        template <typename Tp>
+        void decrement_buckets(Tp const &elem, T value = 1)
+        {
+            increment_buckets(elem, -value);
+        }
+
+        //
+        // median estimation
+        //
+
+        template <typename Tp>
+        T count(Tp const &elem) const
+        {
+            std::array<T, sizeof...(Hs)> est;
+
+            auto idx = this->bucket_indexes(elem);
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+                est[r] = sign(r, elem) * this->data_[r][idx[r]];
+
+            return median_(est);
+        }
+
+        //
+        // F2 (second frequency moment) estimation
+        //
+
+        double f2() const
+        {
+            return inner_product(*this);
+        }
+
+        //
+        // inner product of the streams (join size) estimation
+        //
+
+        double inner_product(count_sketch const &other) const
+        {
+            std::array<double, sizeof...(Hs)> est;
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                double sum = 0;
+                for(size_t c = 0; c < W; ++c)
+                    sum += static_cast<double>(this->data_[r][c]) * other.data_[r][c];
+                est[r] = sum;
+            }
+
+            return median_(est);
+        }
+
+        //
+        // merge/subtract another sketch
+        //
+
+        count_sketch &
+        operator+=(count_sketch const &other)
+        {
+            base_type::operator+=(other);
+            return *this;
+        }
+
+        count_sketch &
+        operator-=(count_sketch const &other)
+        {
+            base_type::operator-=(other);
+            return *this;
+        }
+
+    private:
+
+        template <typename V>
+        static V median_(std::array<V, sizeof...(Hs)> &est)
+        {
+            auto m = est.size() / 2;
+
+            std::nth_element(std::begin(est), std::begin(est) + m, std::end(est));
+
+            if (est.size() & 1)
+                return est[m];
+
+            auto lo = *std::max_element(std::begin(est), std::begin(est) + m);
+            return (lo + est[m]) / 2;
+        }
+    };
+
+
+    template <typename T, std::size_t W, typename ...Hs>
+    count_sketch<T, W, Hs...>
+    operator+(count_sketch<T, W, Hs...> lhs, count_sketch<T, W, Hs...> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+    template <typename T, std::size_t W, typename ...Hs>
+    count_sketch<T, W, Hs...>
+    operator-(count_sketch<T, W, Hs...> lhs, count_sketch<T, W, Hs...> const &rhs)
+    {
+        lhs -= rhs;
+        return lhs;
+    }
+
+} // namespace pds
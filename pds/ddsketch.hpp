@@ -0,0 +1,375 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <stdexcept>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // DDSketch: quantiles with relative-error guarantee:
+    //
+    // Masson, Rim, Lee (2019). "DDSketch: A Fast and Fully-Mergeable Quantile
+    // Sketch with Relative-Error Guarantees".
+    //
+    // a value x > 0 falls in the bucket i = ceil(log_gamma(x)), with
+    // gamma = (1 + alpha) / (1 - alpha), and any quantile is returned as
+    // 2 gamma^i / (gamma + 1), within a relative error alpha of the exact one.
+    //
+    // Buckets are kept in a dense window of DenseBins counters, anchored
+    // around the first value (the hot range), and in a sorted sparse store of
+    // SparseBins (index, count) pairs for the outliers on either side of it.
+    // When the sparse store is full, its lowest bucket is collapsed into the
+    // next one up: lower quantiles lose accuracy, upper ones keep the bound.
+    // If all the outliers lie above the dense window, though, the two lowest
+    // of them are merged and the quantiles falling between them lose the
+    // bound as well. Values below the smallest normal double are counted in
+    // a zero bucket; negative and non-finite values are rejected.
+    //
+    // Sketches with the same alpha merge bucket by bucket, in O(buckets).
+    //
+
+    template <size_t DenseBins = 2048, size_t SparseBins = 128>
+    struct ddsketch
+    {
+        static_assert(DenseBins > 0,   "ddsketch: dense store must not be empty!");
+        static_assert(SparseBins >= 2, "ddsketch: sparse store needs at least two buckets!");
+
+        explicit ddsketch(double alpha = 0.01)
+        : alpha_(alpha)
+        , gamma_((1 + alpha) / (1 - alpha))
+        , log_gamma_(std::log(gamma_))
+        {
+            if (!(alpha > 0 && alpha < 1))
+                throw std::invalid_argument("ddsketch: relative accuracy must be in (0,1)!");
+        }
+
+        //
+        // add a value (with count)
+        //
+
+        void update(double value, uint64_t count = 1)
+        {
+            if (!(value >= 0))
+                throw std::domain_error("ddsketch: negative value!");
+            if (std::isinf(value))
+                throw std::domain_error("ddsketch: non-finite value!");
+
+            count_ += count;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+
+            if (value < std::numeric_limits<double>::min())
+                zero_ += count;
+            else
+                add_(index_(value), count);
+        }
+
+        void operator()(double value)
+        {
+            update(value);
+        }
+
+        //
+        // the value at quantile q (q in [0,1])
+        //
+
+        double quantile(double q) const
+        {
+            if (count_ == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            if (q <= 0)
+                return min_;
+            if (q >= 1)
+                return max_;
+
+            auto rank = q * (count_ - 1);
+
+            if (zero_ > rank)
+                return 0;
+
+            double ret = max_, cum = zero_;
+
+            foreach_bucket_([&](int64_t i, uint64_t c) {
+                cum += c;
+                if (cum > rank) {
+                    ret = value_(i);
+                    return true;
+                }
+                return false;
+            });
+
+            return std::max(min_, std::min(ret, max_));
+        }
+
+        //
+        // the fraction of values less than or equal to x (to bucket resolution)
+        //
+
+        double rank(double x) const
+        {
+            if (count_ == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            if (x < min_)
+                return 0;
+            if (x >= max_)
+                return 1;
+
+            double cum = zero_;
+
+            if (x >= std::numeric_limits<double>::min())
+            {
+                auto idx = index_(x);
+                foreach_bucket_([&](int64_t i, uint64_t c) {
+                    if (i > idx)
+                        return true;
+                    cum += c;
+                    return false;
+                });
+            }
+
+            return cum / count_;
+        }
+
+        uint64_t count() const
+        {
+            return count_;
+        }
+
+        uint64_t eval() const
+        {
+            return count_;
+        }
+
+        uint64_t zero_count() const
+        {
+            return zero_;
+        }
+
+        double min() const { return min_; }
+        double max() const { return max_; }
+
+        double relative_accuracy() const
+        {
+            return alpha_;
+        }
+
+        //
+        // number of non-empty buckets
+        //
+
+        size_t buckets() const
+        {
+            size_t n = 0;
+            foreach_bucket_([&](int64_t, uint64_t) { n++; return false; });
+            return n;
+        }
+
+        void reset()
+        {
+            *this = ddsketch(alpha_);
+        }
+
+        //
+        // merge another sketch (with the same relative accuracy)
+        //
+
+        ddsketch &
+        operator+=(ddsketch const &other)
+        {
+            if (alpha_ != other.alpha_)
+                throw std::invalid_argument("ddsketch: merging sketches with different relative accuracy!");
+
+            if (other.count_ == 0)
+                return *this;
+
+            count_ += other.count_;
+            zero_  += other.zero_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+
+            if (!anchored_) {
+                offset_   = other.offset_;
+                anchored_ = other.anchored_;
+            }
+
+            if (offset_ == other.offset_)
+            {
+                for(size_t i = 0; i < DenseBins; ++i)
+                    dense_[i] += other.dense_[i];
+
+                for(size_t i = 0; i < other.nsparse_; ++i)
+                    add_(other.sparse_[i].first, other.sparse_[i].second);
+            }
+            else
+            {
+                other.foreach_bucket_([&](int64_t i, uint64_t c) {
+                    add_(i, c);
+                    return false;
+                });
+            }
+
+            return *this;
+        }
+
+    private:
+
+        int64_t index_(double value) const
+        {
+            return static_cast<int64_t>(std::ceil(std::log(value) / log_gamma_));
+        }
+
+        double value_(int64_t i) const
+        {
+            return 2 * std::exp(i * log_gamma_) / (gamma_ + 1);
+        }
+
+        void add_(int64_t i, uint64_t c)
+        {
+            if (!anchored_) {
+                offset_   = i - static_cast<int64_t>(DenseBins / 2);
+                anchored_ = true;
+            }
+
+            auto d = i - offset_;
+            if (d >= 0 && d < static_cast<int64_t>(DenseBins))
+                dense_[static_cast<size_t>(d)] += c;
+            else
+                sparse_add_(i, c);
+        }
+
+        void sparse_add_(int64_t i, uint64_t c)
+        {
+            auto it = lower_(i);
+            if (it != end_() && it->first == i) {
+                it->second += c;
+                return;
+            }
+
+            if (nsparse_ == SparseBins) {
+                collapse_lowest_();
+                it = lower_(i);
+                if (it != end_() && it->first == i) {
+                    it->second += c;
+                    return;
+                }
+            }
+
+            std::move_backward(it, end_(), end_() + 1);
+            *it = std::make_pair(i, c);
+            nsparse_++;
+        }
+
+        //
+        // fold the lowest sparse bucket into the next bucket up, which is the
+        // first of the dense window when the outlier lies below it, or the
+        // next upper outlier when none lies below the window
+        //
+
+        void collapse_lowest_()
+        {
+            auto lo = sparse_[0];
+            std::move(std::begin(sparse_) + 1, end_(), std::begin(sparse_));
+            nsparse_--;
+
+            if (lo.first < offset_ && !(sparse_[0].first < offset_))
+                dense_[0] += lo.second;
+            else
+                sparse_[0].second += lo.second;
+        }
+
+        std::pair<int64_t, uint64_t> *
+        lower_(int64_t i)
+        {
+            return std::lower_bound(std::begin(sparse_), end_(), i, [](std::pair<int64_t, uint64_t> const &b, int64_t x) {
+                return b.first < x;
+            });
+        }
+
+        std::pair<int64_t, uint64_t> *
+        end_()
+        {
+            return std::begin(sparse_) + nsparse_;
+        }
+
+        //
+        // visit the non-empty buckets in increasing order, until fun returns true
+        //
+
+        template <typename Fun>
+        void foreach_bucket_(Fun fun) const
+        {
+            size_t s = 0;
+            for(; s < nsparse_ && sparse_[s].first < offset_; ++s)
+                if (fun(sparse_[s].first, sparse_[s].second))
+                    return;
+
+            for(size_t i = 0; i < DenseBins; ++i)
+                if (dense_[i] && fun(offset_ + static_cast<int64_t>(i), dense_[i]))
+                    return;
+
+            for(; s < nsparse_; ++s)
+                if (fun(sparse_[s].first, sparse_[s].second))
+                    return;
+        }
+
+        double alpha_;
+        double gamma_;
+        double log_gamma_;
+
+        std::array<uint64_t, DenseBins> dense_ = {};
+        int64_t offset_ = 0;
+        bool anchored_ = false;
+
+        std::array<std::pair<int64_t, uint64_t>, SparseBins> sparse_;
+        size_t nsparse_ = 0;
+
+        uint64_t zero_  = 0;
+        uint64_t count_ = 0;
+        double min_ = std::numeric_limits<double>::infinity();
+        double max_ = -std::numeric_limits<double>::infinity();
+    };
+
+
+    template <size_t DenseBins, size_t SparseBins>
+    ddsketch<DenseBins, SparseBins>
+    operator+(ddsketch<DenseBins, SparseBins> lhs, ddsketch<DenseBins, SparseBins> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
@@ -0,0 +1,261 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+namespace pds {
+
+    //
+    // Forward decayed counter, cell of a decayed_sketch:
+    //
+    // the value holds the sum of the weights w * exp(lambda (t - L)), where L
+    // is the landmark of the epoch the counter was last normalized to.
+    //
+
+    struct decayed_counter
+    {
+        double   value = 0.0;
+        uint32_t epoch = 0;
+    };
+
+    //
+    // Time-decayed count-min sketch:
+    //
+    // Cormode, G.; Shkapenyuk, V.; Srivastava, D.; Xu, B. (2009). "Forward Decay:
+    // A Practical Time Decay Model for Streaming Systems". ICDE 2009, pp. 138–149.
+    //
+    // Exponential decay exp(-lambda (now - t)) is computed as forward decay with a
+    // global landmark: updates add exp(lambda (t - L)) and queries scale by
+    // exp(-lambda (now - L)), so decaying never touches the table. When the
+    // exponent grows too large a new landmark (epoch) is taken, and counters of
+    // the previous epoch are renormalized lazily the first time they are touched.
+    // Landmarks are more than max_exponent/lambda apart: a counter two or more
+    // epochs old is scaled by less than exp(-max_exponent) and is taken as zero,
+    // so that only the last two landmarks are kept.
+    //
+    // Timestamps are doubles in the same unit as 1/lambda.
+    //
+
+    template <std::size_t W, typename ...Hs>
+    struct decayed_sketch
+    {
+        using sketch_type = sketch<decayed_counter, W, Hs...>;
+
+        static constexpr double max_exponent = 64.0;
+
+        template <typename ...Xs>
+        decayed_sketch(double lambda, Xs ... xs)
+        : sketch_(xs...)
+        , lambda_(lambda)
+        { }
+
+        //
+        // add the weight of the element seen at the given time
+        //
+
+        template <typename Tp>
+        void update(Tp const &elem, double time, double weight = 1.0)
+        {
+            if (lambda_ * (time - landmark_) > max_exponent) {
+                previous_ = landmark_;
+                landmark_ = time;
+                epoch_++;
+            }
+
+            now_ = std::max(now_, time);
+
+            auto w = weight * std::exp(lambda_ * (time - landmark_));
+
+            sketch_.foreach_bucket(elem, [&](decayed_counter &c) {
+                c.value = normalize_(c);
+                c.epoch = epoch_;
+                c.value += w;
+            });
+        }
+
+        template <typename Tp>
+        void increment_buckets(Tp const &elem, double time)
+        {
+            update(elem, time, 1.0);
+        }
+
+        //
+        // decayed count-min estimation at the given time (default: latest seen)
+        //
+
+        template <typename Tp>
+        double count(Tp const &elem, double now) const
+        {
+            double n = std::numeric_limits<double>::max();
+
+            sketch_.foreach_bucket(elem, [&](decayed_counter const &c) {
+                n = std::min(n, normalize_(c));
+            });
+
+            return n * scale_(now);
+        }
+
+        template <typename Tp>
+        double count(Tp const &elem) const
+        {
+            return count(elem, now_);
+        }
+
+        //
+        // minimum across rows of the decayed row sums
+        //
+
+        double minsum(double now) const
+        {
+            double sum = std::numeric_limits<double>::max();
+
+            for(auto const & r : sketch_.data_)
+            {
+                double row = 0.0;
+                for(auto const & c : r)
+                    row += normalize_(c);
+                sum = std::min(sum, row);
+            }
+
+            return sum * scale_(now);
+        }
+
+        double minsum() const
+        {
+            return minsum(now_);
+        }
+
+        //
+        // return the indexes of buckets whose decayed value holds the given
+        // predicate. to the predicate are passed the decayed value of the bucket
+        // and the decayed minsum.
+        //
+
+        template <typename Fun>
+        auto indexes(Fun pred, double now) const
+        {
+            std::vector<std::vector<size_t>> ret;
+
+            auto s   = scale_(now);
+            auto sum = minsum(now);
+
+            for(auto const & r : sketch_.data_)
+            {
+                std::vector<size_t> row;
+                size_t j = 0;
+
+                for(auto const & c : r)
+                {
+                    if (pred(normalize_(c) * s, sum))
+                        row.push_back(j);
+                    j++;
+                }
+
+                ret.push_back(std::move(row));
+            }
+
+            return ret;
+        }
+
+        template <typename Fun>
+        auto indexes(Fun pred) const
+        {
+            return indexes(pred, now_);
+        }
+
+        //
+        // the underlying sketch (e.g. for reverse_sketch)
+        //
+
+        sketch_type const &
+        counters() const
+        {
+            return sketch_;
+        }
+
+        double
+        time() const
+        {
+            return now_;
+        }
+
+        void
+        reset()
+        {
+            sketch_.reset();
+            landmark_ = previous_ = now_;
+            epoch_ = 0;
+        }
+
+        constexpr inline std::pair<size_t, size_t>
+        size() const
+        {
+            return std::make_pair(sizeof...(Hs), W);
+        }
+
+    private:
+
+        //
+        // value of the counter relative to the current landmark
+        //
+
+        double
+        normalize_(decayed_counter const &c) const
+        {
+            switch(static_cast<uint32_t>(epoch_ - c.epoch))
+            {
+            case 0:  return c.value;
+            case 1:  return c.value * std::exp(-lambda_ * (landmark_ - previous_));
+            default: return 0.0;
+            }
+        }
+
+        double
+        scale_(double now) const
+        {
+            return std::exp(-lambda_ * (now - landmark_));
+        }
+
+        sketch_type sketch_;
+
+        double lambda_;
+        double now_ = 0.0;
+
+        double   landmark_ = 0.0;   // current and previous landmarks
+        double   previous_ = 0.0;
+        uint32_t epoch_ = 0;
+    };
+
+} // namespace pds
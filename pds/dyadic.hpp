@@ -0,0 +1,230 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+#include <pds/range.hpp>
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Dyadic count-min sketch:
+    //
+    // Cormode, Muthukrishnan (2005). "An Improved Data Stream Summary: The
+    // Count-Min Sketch and its Applications". J. Algorithms 55(1).
+    //
+    // integer keys in [0, 2^Bits) are counted at every dyadic level j (key >> j).
+    // A range [lo, hi] is decomposed in at most 2 * Bits dyadic intervals, and
+    // the phi-quantile is found descending the levels from the root. Levels
+    // whose domain fits in W buckets are kept as exact counters; the others
+    // are count-min sketches.
+    //
+
+    template <typename T, size_t Bits, std::size_t W, typename ...Hs>
+    struct dyadic_sketch
+    {
+        static_assert(Bits > 0 && Bits <= 63, "dyadic_sketch: Bits must be in [1,63]!");
+
+        using sketch_type = sketch<T, W, Hs...>;
+
+        static constexpr uint64_t universe = 1ULL << Bits;
+
+        //
+        // levels j >= exact_from have at most W distinct values
+        //
+
+        static constexpr size_t exact_from = Bits > hash_bitsize<type_at_t<0, Hs...>>::value ?
+                                             Bits - hash_bitsize<type_at_t<0, Hs...>>::value : 0;
+
+        template <typename ...Xs>
+        dyadic_sketch(Xs ... xs)
+        {
+            for(size_t j = 0; j < exact_from; ++j)
+                sketch_.emplace_back(xs...);
+
+            for(size_t j = exact_from; j < Bits; ++j)
+                exact_.emplace_back(1ULL << (Bits - j));
+        }
+
+        //
+        // update all the levels with the given key
+        //
+
+        void update(uint64_t key, T value = 1)
+        {
+            key &= universe - 1;
+
+            for(size_t j = 0; j < exact_from; ++j)
+                sketch_[j].foreach_bucket(key >> j, [value](T &b) { b += value; });
+
+            for(size_t j = exact_from; j < Bits; ++j)
+                exact_[j - exact_from][key >> j] += value;
+
+            total_ += value;
+        }
+
+        void operator()(uint64_t key)
+        {
+            update(key, 1);
+        }
+
+        //
+        // estimated count of a key
+        //
+
+        T count(uint64_t key) const
+        {
+            return node_(0, key & (universe - 1));
+        }
+
+        //
+        // estimated count of the keys in [lo, hi]
+        //
+
+        T range_count(uint64_t lo, uint64_t hi) const
+        {
+            hi = std::min(hi, universe - 1);
+            if (lo > hi)
+                return T{};
+
+            T sum = T{};
+            uint64_t l = lo, h = hi + 1;
+
+            for(size_t j = 0; l < h; ++j, l >>= 1, h >>= 1)
+            {
+                if (j == Bits)
+                    return total_;
+
+                if (l & 1)
+                    sum += node_(j, l++);
+                if (h & 1)
+                    sum += node_(j, --h);
+            }
+
+            return sum;
+        }
+
+        //
+        // keys are unsigned: for signed ranges the negative part is clamped
+        //
+
+        template <typename V>
+        T range_count(numeric_range<V> const &r) const
+        {
+            if (r.max_ < V{})
+                return T{};
+
+            auto lo = std::max(r.min_, V{});
+            return range_count(static_cast<uint64_t>(lo), static_cast<uint64_t>(r.max_));
+        }
+
+        //
+        // the smallest key x such that range_count(0, x) >= phi * total()
+        //
+
+        uint64_t quantile(double phi) const
+        {
+            auto target = std::max<T>(static_cast<T>(std::ceil(phi * total_)), T{1});
+            uint64_t node = 0;
+
+            for(size_t j = Bits; j-- > 0; )
+            {
+                auto left = node << 1;
+                auto c = node_(j, left);
+
+                if (c >= target)
+                    node = left;
+                else {
+                    target -= c;
+                    node = left + 1;
+                }
+            }
+
+            return node;
+        }
+
+        T total() const
+        {
+            return total_;
+        }
+
+        T eval() const
+        {
+            return total_;
+        }
+
+        void reset()
+        {
+            for(auto & s : sketch_)
+                s.reset();
+            for(auto & e : exact_)
+                std::fill(std::begin(e), std::end(e), T{});
+            total_ = T{};
+        }
+
+        dyadic_sketch &
+        operator+=(dyadic_sketch const &other)
+        {
+            for(size_t j = 0; j < sketch_.size(); ++j)
+                sketch_[j] += other.sketch_[j];
+
+            for(size_t j = 0; j < exact_.size(); ++j)
+                for(size_t i = 0; i < exact_[j].size(); ++i)
+                    exact_[j][i] += other.exact_[j][i];
+
+            total_ += other.total_;
+            return *this;
+        }
+
+    private:
+
+        T node_(size_t j, uint64_t v) const
+        {
+            return j < exact_from ? sketch_[j].count(v) : exact_[j - exact_from][v];
+        }
+
+        std::vector<sketch_type> sketch_;
+        std::vector<std::vector<T>> exact_;
+        T total_ = T{};
+    };
+
+
+    template <typename T, size_t Bits, std::size_t W, typename ...Hs>
+    dyadic_sketch<T, Bits, W, Hs...>
+    operator+(dyadic_sketch<T, Bits, W, Hs...> lhs, dyadic_sketch<T, Bits, W, Hs...> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
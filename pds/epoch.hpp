@@ -0,0 +1,324 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Epoch rotating structure:
+    //
+    // keeps N instances of a Structure (sketch, hyperloglog, ...) providing reset().
+    // The ingest thread updates the active instance; rotate() makes it the stable
+    // snapshot of the interval just closed and activates a spare, already cleared,
+    // instance. Readers pin the snapshot with an RCU-like handle, and retired
+    // instances are cleared by collect() -- either lazily or by the background
+    // collector thread -- once no reader is using them.
+    //
+    // With N = 3 there are an active, a snapshot and a spare instance. rotate()
+    // clears the spare inline only when the collector has not done it yet, and
+    // waits for readers that still pin a retired snapshot.
+    //
+
+    template <typename Structure, size_t N = 3>
+    struct epoch_rotating
+    {
+        static_assert(N >= 3, "epoch_rotating: at least 3 instances are required (active, snapshot and spare)");
+
+        enum : int { clean, live, dirty, clearing };
+
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct slot
+        {
+            template <typename ...Xs>
+            slot(Xs const & ... xs)
+            : value(xs...)
+            { }
+
+            Structure value;
+            uint64_t epoch = 0;
+            std::atomic<size_t> readers{0};
+            std::atomic<int> state{clean};
+        };
+
+        //
+        // snapshot handle: pins the instance until destroyed
+        //
+
+        struct snapshot_handle
+        {
+            snapshot_handle(slot *s = nullptr)
+            : slot_(s)
+            { }
+
+            snapshot_handle(snapshot_handle const &) = delete;
+            snapshot_handle& operator=(snapshot_handle const &) = delete;
+
+            snapshot_handle(snapshot_handle &&other) noexcept
+            : slot_(other.slot_)
+            {
+                other.slot_ = nullptr;
+            }
+
+            snapshot_handle&
+            operator=(snapshot_handle &&other) noexcept
+            {
+                if (this != &other) {
+                    release();
+                    slot_ = other.slot_;
+                    other.slot_ = nullptr;
+                }
+                return *this;
+            }
+
+            ~snapshot_handle()
+            {
+                release();
+            }
+
+            void release()
+            {
+                if (slot_) {
+                    slot_->readers.fetch_sub(1);
+                    slot_ = nullptr;
+                }
+            }
+
+            explicit operator bool() const
+            {
+                return slot_ != nullptr;
+            }
+
+            Structure const & operator*()  const { return slot_->value;  }
+            Structure const * operator->() const { return &slot_->value; }
+
+            uint64_t epoch() const
+            {
+                return slot_->epoch;
+            }
+
+        private:
+            slot *slot_;
+        };
+
+        template <typename ...Xs>
+        epoch_rotating(Xs const & ... xs)
+        {
+            for(auto & s : slots_)
+                s.reset(new slot(xs...));
+
+            slots_[0]->state = live;
+        }
+
+        epoch_rotating(epoch_rotating const &) = delete;
+        epoch_rotating& operator=(epoch_rotating const &) = delete;
+
+        ~epoch_rotating()
+        {
+            stop_collector();
+        }
+
+        //
+        // the active instance (ingest thread only)
+        //
+
+        Structure &
+        current()
+        {
+            return slots_[active_]->value;
+        }
+
+        uint64_t
+        epoch() const
+        {
+            return epoch_;
+        }
+
+        //
+        // close the current interval (ingest thread only):
+        // the active instance becomes the snapshot, a spare one becomes active.
+        //
+
+        void
+        rotate()
+        {
+            auto next = (active_ + 1) % N;
+            auto & s  = *slots_[next];
+
+            while (s.state.load() != clean)
+            {
+                if (!clear(s))
+                    std::this_thread::yield();
+            }
+
+            s.epoch = epoch_ + 1;
+            s.state = live;
+
+            auto retired = snapshot_.exchange(active_);
+            active_ = next;
+            epoch_++;
+
+            if (retired != npos)
+            {
+                slots_[retired]->state = dirty;
+
+                if (collector_.joinable())
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    pending_ = true;
+                    cond_.notify_one();
+                }
+            }
+        }
+
+        //
+        // pin the snapshot of the last closed interval (any thread).
+        // The returned handle is empty before the first rotate().
+        //
+
+        snapshot_handle
+        snapshot() const
+        {
+            for(;;)
+            {
+                auto n = snapshot_.load();
+                if (n == npos)
+                    return snapshot_handle{};
+
+                auto & s = *slots_[n];
+                s.readers.fetch_add(1);
+
+                if (snapshot_.load() == n)
+                    return snapshot_handle{&s};
+
+                s.readers.fetch_sub(1);
+            }
+        }
+
+        //
+        // clear the retired instances no reader is pinning (any thread).
+        // Return the number of instances cleared.
+        //
+
+        size_t
+        collect()
+        {
+            size_t n = 0;
+            for(auto & s : slots_)
+            {
+                if (clear(*s))
+                    n++;
+            }
+            return n;
+        }
+
+        //
+        // background collector
+        //
+
+        void
+        start_collector()
+        {
+            if (collector_.joinable())
+                return;
+
+            stop_ = false;
+            collector_ = std::thread([this] {
+                std::unique_lock<std::mutex> lock(mutex_);
+                for(;;)
+                {
+                    cond_.wait(lock, [this] { return pending_ || stop_; });
+                    if (stop_)
+                        break;
+
+                    pending_ = false;
+                    lock.unlock();
+                    collect();
+                    lock.lock();
+                }
+            });
+        }
+
+        void
+        stop_collector()
+        {
+            if (!collector_.joinable())
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+                cond_.notify_one();
+            }
+
+            collector_.join();
+        }
+
+    private:
+
+        bool
+        clear(slot &s)
+        {
+            int expected = dirty;
+
+            if (s.readers.load() != 0 ||
+                !s.state.compare_exchange_strong(expected, clearing))
+                return false;
+
+            if (s.readers.load() != 0) {
+                s.state = dirty;
+                return false;
+            }
+
+            s.value.reset();
+            s.state = clean;
+            return true;
+        }
+
+        std::array<std::unique_ptr<slot>, N> slots_;
+
+        size_t active_ = 0;
+        uint64_t epoch_ = 0;
+        std::atomic<size_t> snapshot_{npos};
+
+        std::thread collector_;
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        bool pending_ = false;
+        bool stop_ = false;
+    };
+
+} // namespace pds
@@ -0,0 +1,310 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+
+#include <array>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace pds {
+
+    //
+    // Sketch-based change detection:
+    //
+    // Krishnamurthy, Sen, Zhang, Chen (2003). "Sketch-based Change Detection:
+    // Methods, Evaluation, and Applications". IMC 2003.
+    //
+    // at the end of each interval the observed (k-ary) sketch is compared with
+    // a forecast sketch built from the past intervals; the forecast error
+    // sketch is linear, so the error of a key is estimated from its buckets
+    // and the keys whose error exceeds T * sqrt(F2(error)) are flagged.
+    // Forecast and error sketches are updated in place by a single fused pass
+    // over the buckets (zip_apply), without temporary sketches.
+    //
+
+    namespace details
+    {
+        template <std::size_t W, typename ...Hs>
+        inline double
+        kary_f2(sketch<double, W, Hs...> const &s)
+        {
+            std::array<double, sizeof...(Hs)> est;
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                double sum = 0, sq = 0;
+                for(auto v : s.data_[r]) {
+                    sum += v;
+                    sq  += v * v;
+                }
+                est[r] = (W * sq - sum * sum) / (W - 1.0);
+            }
+
+            auto m = est.size() / 2;
+            std::nth_element(std::begin(est), std::begin(est) + m, std::end(est));
+            return std::max(est[m], 0.0);
+        }
+
+        //
+        // indexes of the buckets whose k-ary estimate exceeds threshold
+        // (in absolute value)
+        //
+
+        template <std::size_t W, typename ...Hs>
+        inline auto
+        kary_indexes(sketch<double, W, Hs...> const &s, double threshold)
+        {
+            std::vector<std::vector<size_t>> ret(sizeof...(Hs));
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                auto const &row = s.data_[r];
+                auto mean = std::accumulate(std::begin(row), std::end(row), 0.0) / W;
+
+                for(size_t c = 0; c < W; ++c)
+                {
+                    if (std::abs((row[c] - mean) / (1.0 - 1.0 / W)) >= threshold)
+                        ret[r].push_back(c);
+                }
+            }
+
+            return ret;
+        }
+
+    } // namespace details
+
+    //
+    // common part: the forecast error sketch
+    //
+
+    template <std::size_t W, typename ...Hs>
+    struct forecast_error
+    {
+        using sketch_type = sketch<double, W, Hs...>;
+
+        template <typename ...Xs>
+        forecast_error(Xs ... xs)
+        : error_(xs...)
+        { }
+
+        sketch_type const &
+        error() const
+        {
+            return error_;
+        }
+
+        //
+        // estimated forecast error of a key
+        //
+
+        template <typename Tp>
+        double error(Tp const &elem) const
+        {
+            return error_.estimate(elem);
+        }
+
+        //
+        // estimated second moment of the forecast error
+        //
+
+        double error_f2() const
+        {
+            return details::kary_f2(error_);
+        }
+
+        //
+        // indexes of the buckets whose error exceeds t * sqrt(F2), ready
+        // for reverse_sketch(error(), anomalies(t))
+        //
+
+        auto anomalies(double t) const
+        {
+            return details::kary_indexes(error_, t * std::sqrt(error_f2()));
+        }
+
+        size_t intervals() const
+        {
+            return intervals_;
+        }
+
+    protected:
+        sketch_type error_;
+        size_t intervals_ = 0;
+    };
+
+    //
+    // EWMA forecast:  F(t+1) = a * O(t) + (1 - a) * F(t)
+    //
+
+    template <std::size_t W, typename ...Hs>
+    struct ewma_forecast : forecast_error<W, Hs...>
+    {
+        using sketch_type = sketch<double, W, Hs...>;
+
+        template <typename ...Xs>
+        ewma_forecast(double alpha, Xs ... xs)
+        : forecast_error<W, Hs...>(xs...)
+        , alpha_(alpha)
+        , forecast_(xs...)
+        { }
+
+        //
+        // close an interval with the observed sketch
+        //
+
+        template <typename U>
+        void update(sketch<U, W, Hs...> const &observed)
+        {
+            auto a = alpha_;
+
+            if (this->intervals_++ == 0)
+                zip_apply([](double &e, double &f, U const &o) {
+                            e = 0;
+                            f = o;
+                          }, this->error_, forecast_, observed);
+            else
+                zip_apply([a](double &e, double &f, U const &o) {
+                            e = o - f;
+                            f = a * o + (1 - a) * f;
+                          }, this->error_, forecast_, observed);
+        }
+
+        sketch_type const &
+        forecast() const
+        {
+            return forecast_;
+        }
+
+        void reset()
+        {
+            this->error_.reset();
+            this->intervals_ = 0;
+            forecast_.reset();
+        }
+
+    private:
+        double alpha_;
+        sketch_type forecast_;
+    };
+
+    //
+    // non-seasonal Holt-Winters forecast:
+    //
+    //  F(t+1) = L(t) + B(t)
+    //  L(t)   = a * O(t) + (1 - a) * F(t)
+    //  B(t)   = b * (L(t) - L(t-1)) + (1 - b) * B(t-1)
+    //
+
+    template <std::size_t W, typename ...Hs>
+    struct holt_winters_forecast : forecast_error<W, Hs...>
+    {
+        using sketch_type = sketch<double, W, Hs...>;
+
+        template <typename ...Xs>
+        holt_winters_forecast(double alpha, double beta, Xs ... xs)
+        : forecast_error<W, Hs...>(xs...)
+        , alpha_(alpha)
+        , beta_(beta)
+        , level_(xs...)
+        , trend_(xs...)
+        { }
+
+        template <typename U>
+        void update(sketch<U, W, Hs...> const &observed)
+        {
+            auto a = alpha_, b = beta_;
+
+            switch(this->intervals_++)
+            {
+            case 0:
+                zip_apply([](double &e, double &l, double &t, U const &o) {
+                            e = 0;
+                            l = o;
+                            t = 0;
+                          }, this->error_, level_, trend_, observed);
+                break;
+            case 1:
+                zip_apply([](double &e, double &l, double &t, U const &o) {
+                            e = o - l;
+                            t = o - l;
+                            l = o;
+                          }, this->error_, level_, trend_, observed);
+                break;
+            default:
+                zip_apply([a, b](double &e, double &l, double &t, U const &o) {
+                            auto f  = l + t;
+                            auto nl = a * o + (1 - a) * f;
+                            e = o - f;
+                            t = b * (nl - l) + (1 - b) * t;
+                            l = nl;
+                          }, this->error_, level_, trend_, observed);
+            }
+        }
+
+        //
+        // the forecast of the next interval (level + trend)
+        //
+
+        template <typename Tp>
+        double forecast(Tp const &elem) const
+        {
+            return level_.estimate(elem) + trend_.estimate(elem);
+        }
+
+        sketch_type const &
+        level() const
+        {
+            return level_;
+        }
+
+        sketch_type const &
+        trend() const
+        {
+            return trend_;
+        }
+
+        void reset()
+        {
+            this->error_.reset();
+            this->intervals_ = 0;
+            level_.reset();
+            trend_.reset();
+        }
+
+    private:
+        double alpha_;
+        double beta_;
+        sketch_type level_;
+        sketch_type trend_;
+    };
+
+} // namespace pds
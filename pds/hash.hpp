@@ -31,6 +31,8 @@
 #include <pds/utility.hpp>
 
 #include <functional>
+#include <algorithm>
+#include <vector>
 
 
 namespace std
@@ -106,6 +108,18 @@ namespace pds {
         }
 
 
+        template <size_t J, typename HashValue>
+        bool
+        sub_matches(HashValue value, std::vector<size_t> const &idx) const
+        {
+            size_t h = value & make_mask(hash_bitsize<type_at_t<J, Hs...>>::value);
+
+            return std::any_of(std::begin(idx), std::end(idx), [h](size_t i) {
+                                return sub_value<J>(i) == h;
+                               });
+        }
+
+
         template <size_t I>
         decltype(auto) 
         sub_hash() const
@@ -113,6 +127,20 @@ namespace pds {
             return std::get<I>(hash_);
         }
 
+        template <size_t I>
+        using sub_hash_type = type_at_t<I, Hs...>;
+
+        //
+        // extract the J-th component from a hash value (bucket index)
+        //
+
+        template <size_t J>
+        static constexpr size_t
+        sub_value(size_t value)
+        {
+            return (value >> (hash_offset<J, Hs...>::value)) & make_mask(hash_bitsize<type_at_t<J, Hs...>>::value);
+        }
+
     private:
 
         std::tuple<Hs...> hash_;
@@ -418,6 +446,46 @@ namespace pds {
 		}
     };
 
+    //
+    // 64-bit mixer (splitmix64 finalizer)
+    //
+
+    struct Mix64
+    {
+        uint64_t operator()(uint64_t x) const
+        {
+            x ^= x >> 30;
+            x *= 0xbf58476d1ce4e5b9ULL;
+            x ^= x >> 27;
+            x *= 0x94d049bb133111ebULL;
+            x ^= x >> 31;
+            return x;
+        }
+    };
+
+    //
+    // seeded 64-bit hash of a value (or of the components of a tuple)
+    //
+
+    template <typename T>
+    inline uint64_t hash64(T const &value, uint64_t seed)
+    {
+        return Mix64{}(seed ^ std::hash<T>{}(value));
+    }
+
+    template <typename ...Ts>
+    inline uint64_t hash64(std::tuple<Ts...> const &value, uint64_t seed)
+    {
+        uint64_t h = seed;
+
+        tuple_foreach([&](auto const &elem)
+        {
+            h = hash64(elem, h + 0x9e3779b97f4a7c15ULL);
+        }, value);
+
+        return h;
+    }
+
 } // namespace pds
 
 
@@ -0,0 +1,285 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+#include <pds/hash.hpp>
+#include <pds/utility.hpp>
+
+#include <array>
+#include <tuple>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Hierarchical heavy hitters over IPv4 prefixes:
+    //
+    // Cormode, Korn, Muthukrishnan, Srivastava (2003). "Finding Hierarchical
+    // Heavy Hitters in Data Streams". VLDB 2003.
+    //
+    // one count-min sketch per prefix level (/8, /16, /24, /32). The key of
+    // level L is the tuple of the first L octets, hashed by a ModularHash of
+    // L components HashFold<B, H> (the most significant octet is component 0,
+    // in the low bits of the index). The index of a prefix at level L is then
+    // the index of the address at /32 masked to L*B bits: update() hashes the
+    // address once per row and increments all the levels in a single pass.
+    //
+    // The /32 level has 2^(4*B) buckets per row, hence B is at most 6
+    // (2^24 counters per row).
+    // Each level is a plain pds::sketch, so that it can be queried or reversed
+    // on its own (e.g. reverse_sketch<uint8_t, uint8_t>(level<2>(), ...)).
+    //
+
+    namespace details
+    {
+        template <typename H, size_t I>
+        using repeat_hash_ = H;
+
+        template <typename H, typename Seq> struct repeat_modular_hash;
+
+        template <typename H, size_t ...I>
+        struct repeat_modular_hash<H, std::index_sequence<I...>>
+        {
+            using type = ModularHash<repeat_hash_<H, I>...>;
+        };
+
+        template <size_t ...I>
+        inline auto
+        octets_prefix(std::array<uint8_t, 4> const &o, std::index_sequence<I...>)
+        {
+            return std::make_tuple(o[I]...);
+        }
+    }
+
+    //
+    // the octets of an IPv4 address in host byte order, most significant first
+    //
+
+    inline std::array<uint8_t, 4>
+    ip_octets(uint32_t ip)
+    {
+        return {{ static_cast<uint8_t>(ip >> 24), static_cast<uint8_t>(ip >> 16),
+                  static_cast<uint8_t>(ip >> 8),  static_cast<uint8_t>(ip) }};
+    }
+
+    template <size_t L>
+    inline auto
+    ip_prefix_tuple(uint32_t ip)
+    {
+        return details::octets_prefix(ip_octets(ip), std::make_index_sequence<L>());
+    }
+
+
+    template <typename T, size_t B, typename ...Hs>
+    struct hhh_sketch
+    {
+        static_assert(B > 0 && B <= 6, "hhh_sketch: B (bits per octet) must be in [1,6] (2^(4*B) buckets at /32)!");
+
+        static constexpr size_t levels = 4;
+
+        template <size_t L>
+        using level_type = sketch<T, (1ULL << (L * B)),
+                                  typename details::repeat_modular_hash<HashFold<B, Hs>, std::make_index_sequence<L>>::type...>;
+
+        struct entry
+        {
+            uint32_t prefix;
+            size_t   length;     // prefix length: 8, 16, 24 or 32
+            T        count;      // estimated count of the prefix
+            T        discounted; // count not covered by HHH descendants
+        };
+
+        //
+        // update all levels with the given address (host byte order)
+        //
+
+        void update(uint32_t ip, T value = 1)
+        {
+            auto key = ip_prefix_tuple<4>(ip);
+
+            update_rows_(key, value, std::make_index_sequence<sizeof...(Hs)>());
+            total_ += value;
+        }
+
+        void operator()(uint32_t ip)
+        {
+            update(ip, 1);
+        }
+
+        //
+        // estimated count of a prefix (length 8, 16, 24 or 32)
+        //
+
+        T count(uint32_t prefix, size_t length) const
+        {
+            switch(length)
+            {
+            case 8:  return std::get<0>(levels_).count(ip_prefix_tuple<1>(prefix));
+            case 16: return std::get<1>(levels_).count(ip_prefix_tuple<2>(prefix));
+            case 24: return std::get<2>(levels_).count(ip_prefix_tuple<3>(prefix));
+            case 32: return std::get<3>(levels_).count(ip_prefix_tuple<4>(prefix));
+            }
+            return T{};
+        }
+
+        //
+        // hierarchical heavy hitters: the prefixes whose count, discounted by
+        // the counts of their HHH descendants, is at least threshold. The
+        // hierarchy is explored top-down from the heavy /8, expanding only
+        // the children of heavy prefixes. Result by decreasing prefix length.
+        //
+
+        std::vector<entry> hhh(T threshold) const
+        {
+            std::vector<entry> ret;
+
+            for(uint32_t o = 0; o < 256; ++o)
+                search_(o << 24, 8, threshold, ret);
+
+            std::stable_sort(std::begin(ret), std::end(ret), [](entry const &a, entry const &b) {
+                return a.length > b.length;
+            });
+
+            return ret;
+        }
+
+        //
+        // HHH relative to the total count (phi in (0,1])
+        //
+
+        std::vector<entry> hhh_fraction(double phi) const
+        {
+            return hhh(static_cast<T>(phi * total_));
+        }
+
+        uint64_t total() const
+        {
+            return total_;
+        }
+
+        template <size_t L>
+        level_type<L> const &
+        level() const
+        {
+            return std::get<L-1>(levels_);
+        }
+
+        void reset()
+        {
+            reset_(std::make_index_sequence<levels>());
+            total_ = 0;
+        }
+
+        hhh_sketch &
+        operator+=(hhh_sketch const &other)
+        {
+            merge_(other, std::make_index_sequence<levels>());
+            total_ += other.total_;
+            return *this;
+        }
+
+    private:
+
+        //
+        // explore the prefix: return the count covered by HHH in its subtree
+        //
+
+        T search_(uint32_t prefix, size_t length, T threshold, std::vector<entry> &ret) const
+        {
+            auto c = count(prefix, length);
+            if (c < threshold)
+                return T{};
+
+            T covered = T{};
+
+            if (length < 32)
+            {
+                auto shift = 24 - length;
+                for(uint32_t o = 0; o < 256; ++o)
+                    covered += search_(prefix | (o << shift), length + 8, threshold, ret);
+            }
+
+            auto discounted = c > covered ? c - covered : T{};
+
+            if (discounted >= threshold) {
+                ret.push_back(entry{prefix, length, c, discounted});
+                return c;
+            }
+
+            return covered;
+        }
+
+        template <typename Tuple, size_t ...R>
+        void update_rows_(Tuple const &key, T value, std::index_sequence<R...>)
+        {
+            auto sink = { (update_row_<R>(key, value),0)... };
+            (void)sink;
+        }
+
+        template <size_t R, typename Tuple>
+        void update_row_(Tuple const &key, T value)
+        {
+            auto idx = std::get<R>(std::get<levels-1>(levels_).hash_)(key);
+
+            std::get<0>(levels_).data_[R][idx & make_mask(1 * B)] += value;
+            std::get<1>(levels_).data_[R][idx & make_mask(2 * B)] += value;
+            std::get<2>(levels_).data_[R][idx & make_mask(3 * B)] += value;
+            std::get<3>(levels_).data_[R][idx & make_mask(4 * B)] += value;
+        }
+
+        template <size_t ...L>
+        void reset_(std::index_sequence<L...>)
+        {
+            auto sink = { (std::get<L>(levels_).reset(),0)... };
+            (void)sink;
+        }
+
+        template <size_t ...L>
+        void merge_(hhh_sketch const &other, std::index_sequence<L...>)
+        {
+            auto sink = { (std::get<L>(levels_) += std::get<L>(other.levels_),0)... };
+            (void)sink;
+        }
+
+        std::tuple<level_type<1>, level_type<2>, level_type<3>, level_type<4>> levels_;
+        uint64_t total_ = 0;
+    };
+
+
+    template <typename T, size_t B, typename ...Hs>
+    hhh_sketch<T, B, Hs...>
+    operator+(hhh_sketch<T, B, Hs...> lhs, hhh_sketch<T, B, Hs...> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
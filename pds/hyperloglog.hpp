@@ -32,6 +32,8 @@
 #include <iostream>
 
 #include <vector>
+#include <array>
+#include <limits>
 #include <stdexcept>
 #include <functional>
 #include <algorithm>
@@ -68,6 +70,48 @@ namespace pds {
     template <> struct static_alpha<64> { static constexpr double value = 0.709;  };
 
 
+    //
+    // HyperLogLog estimate from the M registers in [it, end), for a hash of L bits
+    //
+
+    template <size_t M, size_t L, typename Iter>
+    double hll_estimate(Iter it, Iter end)
+    {
+        double c = 0.0;
+
+        for(auto i = it; i != end; ++i)
+        {
+            c += 1.0/std::pow(2, *i);
+        }
+
+        double e = static_alpha<M>::value * M * M / c;
+
+        if (e <= (2.5*M))
+        {
+             auto v = std::count_if(it, end,
+                                    [](uint8_t bucket)
+                                    {
+                                        return bucket == 0;
+                                    });
+             if (v != 0)
+             {
+                 e = M * std::log(static_cast<double>(M)/v);
+             }
+        }
+        else
+        {
+            double exp2_L = exp2(L); 
+
+            if (e > exp2_L/30)
+            {
+                e = -exp2_L * std::log(1.0 - e/exp2_L);
+            }
+        }
+
+        return e;
+    }
+
+
     template <typename Tb, size_t M, typename Hash>
     struct hyperloglog
     {
@@ -103,38 +147,7 @@ namespace pds {
 
         double cardinality() const
         {
-            double c = 0.0;
-
-            for(auto bucket : m_)
-            {
-                c += 1.0/std::pow(2, bucket);
-            }
-
-            double e = static_alpha<M>::value * M * M / c;
-
-            if (e <= (2.5*M))
-            {
-                 auto v = std::count_if(std::begin(m_), std::end(m_),
-                                        [](uint8_t bucket)
-                                        {
-                                            return bucket == 0;
-                                        });
-                 if (v != 0)
-                 {
-                     e = M * std::log(static_cast<double>(M)/v);
-                 }
-            }
-            else
-            {
-                double exp2_L = exp2(hash_bitsize<Hash>::value); 
-
-                if (e > exp2_L/30)
-                {
-                    e = -exp2_L * std::log(1.0 - e/exp2_L);
-                }
-            }
-
-            return e;
+            return hll_estimate<M, L>(std::begin(m_), std::end(m_));
         }
 
 	double eval() const
@@ -171,6 +184,16 @@ namespace pds {
             return M;
         }
 
+        //
+        // access to the registers
+        //
+
+        std::vector<Tb> const &
+        registers() const
+        {
+            return m_;
+        }
+
     private:
 
         std::vector<Tb> m_;
@@ -185,4 +208,224 @@ namespace pds {
         return lhs += rhs;
     }
 
+    ///////////////////////////////////////////////////////////////////////////////
+    //
+    // Joint estimation of two HyperLogLog sketches:
+    //
+    // Ertl, O. (2017). "New cardinality estimation methods for HyperLogLog sketches".
+    //
+    // the sets A and B are split into A\B, B\A and A&B with Poisson rates
+    // (la, lb, lx): the pair of registers j is then (max(Ua,X), max(Ub,X)),
+    // whose likelihood only depends on five histograms of the register values
+    // (a < b, a > b, a = b). They are collected in a single pass over the two
+    // arrays; the log-likelihood is maximized by Nelder-Mead in log space,
+    // starting from the inclusion-exclusion estimate.
+    //
+
+    struct hll_joint_estimate
+    {
+        double a_only;          // |A \ B|
+        double b_only;          // |B \ A|
+        double intersection;    // |A & B|
+
+        double union_cardinality() const
+        {
+            return a_only + b_only + intersection;
+        }
+
+        double jaccard() const
+        {
+            auto u = union_cardinality();
+            return u > 0 ? intersection / u : 0.0;
+        }
+    };
+
+    namespace details
+    {
+        //
+        // minimize fun over N dimensions, from x0 with the initial simplex step
+        //
+
+        template <size_t N, typename Fun>
+        std::array<double, N>
+        nelder_mead(Fun fun, std::array<double, N> const &x0, double step, size_t iterations = 500, double tolerance = 1e-10)
+        {
+            std::array<std::array<double, N>, N + 1> x;
+            std::array<double, N + 1> f;
+
+            for(size_t i = 0; i <= N; ++i)
+            {
+                x[i] = x0;
+                if (i > 0)
+                    x[i][i-1] += step;
+                f[i] = fun(x[i]);
+            }
+
+            auto along = [&](std::array<double, N> const &c, std::array<double, N> const &w, double t) {
+                std::array<double, N> r;
+                for(size_t d = 0; d < N; ++d)
+                    r[d] = c[d] + t * (w[d] - c[d]);
+                return r;
+            };
+
+            for(size_t it = 0; it < iterations; ++it)
+            {
+                // order the vertices by value (N is small)
+
+                for(size_t i = 1; i <= N; ++i)
+                    for(size_t j = i; j > 0 && f[j] < f[j-1]; --j) {
+                        std::swap(f[j], f[j-1]);
+                        std::swap(x[j], x[j-1]);
+                    }
+
+                if (std::abs(f[N] - f[0]) <= tolerance * (std::abs(f[0]) + tolerance))
+                    break;
+
+                std::array<double, N> c = {};
+                for(size_t i = 0; i < N; ++i)
+                    for(size_t d = 0; d < N; ++d)
+                        c[d] += x[i][d] / N;
+
+                auto xr = along(c, x[N], -1.0);
+                auto fr = fun(xr);
+
+                if (fr < f[0]) {
+                    auto xe = along(c, x[N], -2.0);
+                    auto fe = fun(xe);
+                    if (fe < fr) { x[N] = xe; f[N] = fe; }
+                    else         { x[N] = xr; f[N] = fr; }
+                    continue;
+                }
+
+                if (fr < f[N-1]) {
+                    x[N] = xr; f[N] = fr;
+                    continue;
+                }
+
+                auto xc = fr < f[N] ? along(c, xr, 0.5) : along(c, x[N], 0.5);
+                auto fc = fun(xc);
+
+                if (fc < std::min(fr, f[N])) {
+                    x[N] = xc; f[N] = fc;
+                    continue;
+                }
+
+                for(size_t i = 1; i <= N; ++i) {
+                    x[i] = along(x[0], x[i], 0.5);
+                    f[i] = fun(x[i]);
+                }
+            }
+
+            return x[std::min_element(std::begin(f), std::end(f)) - std::begin(f)];
+        }
+
+        //
+        // P(register = k) for a Poisson rate s per register, registers in [0, Q]
+        //
+
+        inline double hll_pmf(double s, size_t k, size_t Q)
+        {
+            if (k == 0)
+                return std::exp(-s);
+            if (k == Q)
+                return -std::expm1(-std::ldexp(s, 1 - static_cast<int>(Q)));
+
+            auto t = std::ldexp(s, -static_cast<int>(k));
+            return std::exp(-t) * -std::expm1(-t);
+        }
+
+        //
+        // P(max(Ua,X) = max(Ub,X) = k) for the rates a, b, x
+        //
+
+        inline double hll_pmf_equal(double a, double b, double x, size_t k, size_t Q)
+        {
+            if (k == 0)
+                return std::exp(-(a + b + x));
+
+            auto e = k == Q ? 1 - static_cast<int>(Q) : -static_cast<int>(k);
+            auto pre = k == Q ? 1.0 : std::exp(-std::ldexp(a + b + x, e));
+
+            return pre * ( std::expm1(-std::ldexp(a + x, e)) * std::expm1(-std::ldexp(b + x, e))
+                         - std::exp(-std::ldexp(a + b + x, e)) * std::expm1(-std::ldexp(x, e)) );
+        }
+    }
+
+
+    template <typename Tb, size_t M, typename Hash>
+    hll_joint_estimate
+    joint_cardinality(hyperloglog<Tb, M, Hash> const &a, hyperloglog<Tb, M, Hash> const &b)
+    {
+        constexpr size_t Q = hyperloglog<Tb, M, Hash>::L - hyperloglog<Tb, M, Hash>::K;
+
+        std::array<double, Q + 1> a_lt = {}, a_gt = {}, b_lt = {}, b_gt = {}, eq = {};
+
+        auto const &ra = a.registers();
+        auto const &rb = b.registers();
+
+        for(size_t j = 0; j < M; ++j)
+        {
+            auto ka = ra[j], kb = rb[j];
+            if (ka < kb) {
+                a_lt[ka]++;
+                b_gt[kb]++;
+            }
+            else if (ka > kb) {
+                a_gt[ka]++;
+                b_lt[kb]++;
+            }
+            else
+                eq[ka]++;
+        }
+
+        auto loglik = [&](std::array<double, 3> const &theta) {
+            auto la = std::exp(theta[0]) / M, lb = std::exp(theta[1]) / M, lx = std::exp(theta[2]) / M;
+
+            double ll = 0;
+            for(size_t k = 0; k <= Q; ++k)
+            {
+                if (a_lt[k]) ll += a_lt[k] * std::log(details::hll_pmf(la + lx, k, Q));
+                if (b_lt[k]) ll += b_lt[k] * std::log(details::hll_pmf(lb + lx, k, Q));
+                if (a_gt[k]) ll += a_gt[k] * std::log(details::hll_pmf(la, k, Q));
+                if (b_gt[k]) ll += b_gt[k] * std::log(details::hll_pmf(lb, k, Q));
+                if (eq[k])   ll += eq[k]   * std::log(details::hll_pmf_equal(la, lb, lx, k, Q));
+            }
+
+            return std::isnan(ll) ? std::numeric_limits<double>::infinity() : -ll;
+        };
+
+        // inclusion-exclusion start, with a floor for empty parts
+
+        auto na = a.cardinality(), nb = b.cardinality(), nu = (a + b).cardinality();
+        auto lo = 1.0;
+
+        auto x0 = std::max(na + nb - nu, lo);
+        std::array<double, 3> theta = { std::log(std::max(na - x0, lo))
+                                      , std::log(std::max(nb - x0, lo))
+                                      , std::log(x0) };
+
+        theta = details::nelder_mead(loglik, theta, 0.5);
+
+        return hll_joint_estimate { std::exp(theta[0]), std::exp(theta[1]), std::exp(theta[2]) };
+    }
+
+
+    template <typename Tb, size_t M, typename Hash>
+    double intersection_cardinality(hyperloglog<Tb, M, Hash> const &a, hyperloglog<Tb, M, Hash> const &b)
+    {
+        return joint_cardinality(a, b).intersection;
+    }
+
+    template <typename Tb, size_t M, typename Hash>
+    double difference_cardinality(hyperloglog<Tb, M, Hash> const &a, hyperloglog<Tb, M, Hash> const &b)
+    {
+        return joint_cardinality(a, b).a_only;
+    }
+
+    template <typename Tb, size_t M, typename Hash>
+    double jaccard(hyperloglog<Tb, M, Hash> const &a, hyperloglog<Tb, M, Hash> const &b)
+    {
+        return joint_cardinality(a, b).jaccard();
+    }
+
 }  // namespace pds
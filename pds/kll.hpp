@@ -0,0 +1,380 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+
+namespace pds {
+
+    //
+    // KLL quantile sketch:
+    //
+    // Karnin, Lang, Liberty (2016). "Optimal Quantile Approximation in Streams". FOCS 2016.
+    //
+    // a stack of compactors: items of level h have weight 2^h. When the sketch
+    // is full, the lowest level over its capacity is sorted and every other
+    // item (random offset) is promoted to the level above. The capacity of
+    // level h out of H is max(8, K * (2/3)^(H-1-h)).
+    //
+    // All the levels live in one contiguous buffer, as in DataSketches:
+    //
+    //     [ free | level 0 | level 1 | ... | level H-1 ]
+    //
+    // level 0 grows downward into the free space and is the only unsorted
+    // level. Queries build a sorted, weighted view of the items lazily.
+    //
+
+    template <typename T, size_t K = 200>
+    struct kll_sketch
+    {
+        static_assert(K >= 8, "kll_sketch: K must be at least 8!");
+
+        kll_sketch(uint64_t seed = 0x2545f4914f6cdd1dULL)
+        : buf_(K)
+        , levels_{K, K}
+        , rand_(seed)
+        { }
+
+        //
+        // update the sketch with a value
+        //
+
+        void update(T const &value)
+        {
+            if (levels_[0] == 0) {
+                if (compress_())
+                    fit_();
+            }
+
+            buf_[--levels_[0]] = value;
+            n_++;
+
+            if (n_ == 1)
+                min_ = max_ = value;
+            else {
+                min_ = std::min(min_, value);
+                max_ = std::max(max_, value);
+            }
+
+            sorted_.clear();
+        }
+
+        void operator()(T const &value)
+        {
+            update(value);
+        }
+
+        //
+        // the value whose rank is phi (phi in [0,1])
+        //
+
+        T quantile(double phi) const
+        {
+            auto const &v = view_();
+
+            if (v.empty())
+                return T{};
+            if (phi <= 0)
+                return min_;
+            if (phi >= 1)
+                return max_;
+
+            auto target = std::max<uint64_t>(static_cast<uint64_t>(std::ceil(phi * n_)), 1);
+
+            auto it = std::lower_bound(std::begin(v), std::end(v), target, [](std::pair<T, uint64_t> const &e, uint64_t w) {
+                        return e.second < w;
+                      });
+
+            return it == std::end(v) ? max_ : it->first;
+        }
+
+        //
+        // the fraction of values less than or equal to the given one
+        //
+
+        double rank(T const &value) const
+        {
+            auto const &v = view_();
+
+            auto it = std::upper_bound(std::begin(v), std::end(v), value, [](T const &x, std::pair<T, uint64_t> const &e) {
+                        return x < e.first;
+                      });
+
+            return it == std::begin(v) ? 0.0 : static_cast<double>(std::prev(it)->second) / n_;
+        }
+
+        uint64_t n() const
+        {
+            return n_;
+        }
+
+        uint64_t eval() const
+        {
+            return n_;
+        }
+
+        T min() const { return min_; }
+        T max() const { return max_; }
+
+        //
+        // number of retained items and memory footprint
+        //
+
+        size_t retained() const
+        {
+            return buf_.size() - levels_[0];
+        }
+
+        size_t memory() const
+        {
+            return sizeof(*this) + (buf_.capacity() + scratch_.capacity()) * sizeof(T) + levels_.capacity() * sizeof(uint32_t);
+        }
+
+        size_t num_levels() const
+        {
+            return levels_.size() - 1;
+        }
+
+        void reset()
+        {
+            buf_.assign(K, T{});
+            levels_ = {K, K};
+            n_ = 0;
+            sorted_.clear();
+        }
+
+        //
+        // merge: levels are concatenated (sorted levels are merged), then
+        // compacted back to the capacity.
+        //
+
+        kll_sketch &
+        operator+=(kll_sketch const &other)
+        {
+            if (other.n_ == 0)
+                return *this;
+
+            auto h = std::max(num_levels(), other.num_levels());
+
+            std::vector<std::vector<T>> lv(h);
+
+            for(size_t l = 0; l < h; ++l)
+            {
+                if (l < num_levels())
+                    lv[l].assign(std::begin(buf_) + levels_[l], std::begin(buf_) + levels_[l+1]);
+
+                if (l < other.num_levels())
+                {
+                    auto mid = lv[l].size();
+                    lv[l].insert(std::end(lv[l]), std::begin(other.buf_) + other.levels_[l],
+                                                  std::begin(other.buf_) + other.levels_[l+1]);
+                    if (l > 0)
+                        std::inplace_merge(std::begin(lv[l]), std::begin(lv[l]) + mid, std::end(lv[l]));
+                }
+            }
+
+            buf_.clear();
+            levels_.assign(1, 0);
+
+            for(auto const &v : lv)
+            {
+                buf_.insert(std::end(buf_), std::begin(v), std::end(v));
+                levels_.push_back(static_cast<uint32_t>(buf_.size()));
+            }
+
+            auto min = n_ ? std::min(min_, other.min_) : other.min_;
+            auto max = n_ ? std::max(max_, other.max_) : other.max_;
+
+            n_ += other.n_;
+            min_ = min;
+            max_ = max;
+
+            while (retained() > capacity_())
+                compress_();
+
+            fit_();
+
+            sorted_.clear();
+            return *this;
+        }
+
+    private:
+
+        static size_t level_capacity_(size_t h, size_t height)
+        {
+            static const auto caps = []
+            {
+                std::array<size_t, 64> ret;
+                for(size_t depth = 0; depth < ret.size(); ++depth)
+                    ret[depth] = std::max<size_t>(8, static_cast<size_t>(std::ceil(K * std::pow(2.0/3.0, depth))));
+                return ret;
+            }();
+
+            return caps[std::min<size_t>(height - 1 - h, caps.size() - 1)];
+        }
+
+        size_t capacity_() const
+        {
+            size_t ret = 0;
+            for(size_t h = 0; h < num_levels(); ++h)
+                ret += level_capacity_(h, num_levels());
+            return ret;
+        }
+
+        //
+        // compact the lowest level over its capacity into the level above;
+        // return true if a new level is added.
+        //
+
+        bool compress_()
+        {
+            auto height = num_levels();
+
+            size_t h = 0;
+            while (h < height - 1 && levels_[h+1] - levels_[h] < level_capacity_(h, height))
+                h++;
+
+            auto grow = h == height - 1;
+            if (grow)
+                levels_.push_back(levels_.back());
+
+            auto a = levels_[h], b = levels_[h+1], c = levels_[h+2];
+
+            if (h == 0)
+                std::sort(std::begin(buf_) + a, std::begin(buf_) + b);
+
+            auto odd   = (b - a) & 1;
+            auto start = a + odd;
+            auto half  = (b - start) / 2;
+            auto off   = static_cast<uint32_t>(rand_() & 1);
+
+            // promote every other item to the tail of the level...
+
+            for(auto i = half; i-- > 0; )
+                buf_[start + half + i] = buf_[start + 2 * i + off];
+
+            // ...merge it with the level above...
+
+            scratch_.resize(c - (b - half));
+            std::merge(std::begin(buf_) + (b - half), std::begin(buf_) + b,
+                       std::begin(buf_) + b, std::begin(buf_) + c, std::begin(scratch_));
+            std::copy(std::begin(scratch_), std::end(scratch_), std::begin(buf_) + (b - half));
+
+            // ...and shift the lower levels up over the freed space
+
+            std::move_backward(std::begin(buf_) + levels_[0], std::begin(buf_) + start, std::begin(buf_) + (b - half));
+
+            for(size_t l = 0; l <= h; ++l)
+                levels_[l] += half;
+
+            levels_[h+1] = b - half;
+            return grow;
+        }
+
+        //
+        // resize the buffer to the capacity of the levels (free space at the front)
+        //
+
+        void fit_()
+        {
+            auto size = std::max(capacity_(), retained());
+            auto used = retained();
+
+            if (size == buf_.size())
+                return;
+
+            std::vector<T> buf(size);
+            std::copy(std::begin(buf_) + levels_[0], std::end(buf_), std::begin(buf) + (size - used));
+
+            auto delta = static_cast<int64_t>(size) - static_cast<int64_t>(buf_.size());
+            for(auto &l : levels_)
+                l = static_cast<uint32_t>(l + delta);
+
+            buf_ = std::move(buf);
+        }
+
+        //
+        // sorted view: (value, cumulative weight)
+        //
+
+        std::vector<std::pair<T, uint64_t>> const &
+        view_() const
+        {
+            if (!sorted_.empty() || n_ == 0)
+                return sorted_;
+
+            sorted_.reserve(retained());
+
+            for(size_t h = 0; h < num_levels(); ++h)
+                for(auto i = levels_[h]; i < levels_[h+1]; ++i)
+                    sorted_.emplace_back(buf_[i], uint64_t{1} << h);
+
+            std::sort(std::begin(sorted_), std::end(sorted_), [](std::pair<T, uint64_t> const &x, std::pair<T, uint64_t> const &y) {
+                return x.first < y.first;
+            });
+
+            uint64_t cum = 0;
+            for(auto &e : sorted_) {
+                cum += e.second;
+                e.second = cum;
+            }
+
+            return sorted_;
+        }
+
+        std::vector<T> buf_;
+        std::vector<uint32_t> levels_;
+
+        uint64_t n_ = 0;
+        T min_ = T{};
+        T max_ = T{};
+
+        xorshift64 rand_;
+        std::vector<T> scratch_;
+
+        mutable std::vector<std::pair<T, uint64_t>> sorted_;
+    };
+
+
+    template <typename T, size_t K>
+    kll_sketch<T, K>
+    operator+(kll_sketch<T, K> lhs, kll_sketch<T, K> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
@@ -0,0 +1,268 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+#include <pds/hash.hpp>
+
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // MinHash signatures with one-permutation hashing:
+    //
+    // Li, Owen, Zhang (2012). "One Permutation Hashing".
+    // Shrivastava (2017). "Optimal Densification for Fast and Accurate Minwise Hashing".
+    // Li, Koenig (2010). "b-Bit Minwise Hashing".
+    //
+    // a single hash per element splits it into one of K bins and keeps the
+    // minimum of the remaining bits per bin; bins left empty by small sets are
+    // filled, when the signature is taken, by probing other bins along a
+    // sequence fixed by the bin index (shared by all the signatures), so that
+    // two sets agree on a slot with probability equal to their Jaccard index.
+    //
+    // The raw bins merge by element-wise minimum (the union of the sets);
+    // signatures can be compressed to the lowest B bits of each slot.
+    //
+
+    template <size_t K, typename Hash = std::hash<uint64_t>>
+    struct minhash
+    {
+        static_assert(K >= 2 && (K & (K-1)) == 0, "minhash: the number of bins must be a power of two!");
+
+        static constexpr size_t bits = log2(K);
+        static constexpr uint64_t empty_bin = std::numeric_limits<uint64_t>::max();
+
+        using signature_type = std::array<uint64_t, K>;
+
+        template <typename X = Hash>
+        minhash(X x = X())
+        : hash_(x)
+        {
+            bins_.fill(empty_bin);
+        }
+
+        //
+        // hash and process the element:
+        //
+
+        template <typename T>
+        void update(T const &elem)
+        {
+            insert_(Mix64{}(hash_(elem)));
+        }
+
+        template <typename T>
+        void operator()(T const &elem)
+        {
+            update(elem);
+        }
+
+        //
+        // process a range of elements: hashes are computed a block at a time,
+        // apart from the scattered minimum, so that the mixing is vectorized
+        //
+
+        template <typename Iter>
+        void update(Iter it, Iter end)
+        {
+            std::array<uint64_t, 64> h;
+
+            while (it != end)
+            {
+                size_t n = 0;
+                for(; n < h.size() && it != end; ++n, ++it)
+                    h[n] = hash_(*it);
+
+                for(size_t i = 0; i < n; ++i)
+                    h[i] = Mix64{}(h[i]);
+
+                for(size_t i = 0; i < n; ++i)
+                    insert_(h[i]);
+            }
+        }
+
+        //
+        // densified signature: K values, one per bin
+        //
+
+        signature_type
+        signature() const
+        {
+            signature_type sig = bins_;
+
+            if (empty_bins() == K)
+                return sig;
+
+            for(size_t i = 0; i < K; ++i)
+            {
+                if (bins_[i] != empty_bin)
+                    continue;
+
+                for(uint64_t attempt = 1; ; ++attempt)
+                {
+                    auto j = hash64(i, attempt) & make_mask(bits);
+                    if (bins_[j] != empty_bin) {
+                        sig[i] = bins_[j];
+                        break;
+                    }
+                }
+            }
+
+            return sig;
+        }
+
+        //
+        // b-bit signature: the lowest B bits of each slot, packed into words
+        //
+
+        template <size_t B>
+        std::array<uint64_t, (K * B + 63) / 64>
+        bbit_signature() const
+        {
+            static_assert(B > 0 && B < 64 && 64 % B == 0, "minhash: B must divide the word size!");
+
+            std::array<uint64_t, (K * B + 63) / 64> ret = {};
+            auto sig = signature();
+
+            for(size_t i = 0; i < K; ++i)
+                ret[i * B / 64] |= (sig[i] & make_mask(B)) << (i * B % 64);
+
+            return ret;
+        }
+
+        //
+        // estimated Jaccard index with another set
+        //
+
+        double jaccard(minhash const &other) const
+        {
+            auto e1 = empty_bins() == K, e2 = other.empty_bins() == K;
+            if (e1 || e2)
+                return e1 && e2 ? 1.0 : 0.0;
+
+            return minhash::jaccard(signature(), other.signature());
+        }
+
+        static double jaccard(signature_type const &a, signature_type const &b)
+        {
+            size_t eq = 0;
+            for(size_t i = 0; i < K; ++i)
+                eq += a[i] == b[i];
+
+            return static_cast<double>(eq) / K;
+        }
+
+        size_t empty_bins() const
+        {
+            size_t n = 0;
+            for(size_t i = 0; i < K; ++i)
+                n += bins_[i] == empty_bin;
+            return n;
+        }
+
+        uint64_t bin(size_t i) const
+        {
+            return bins_[i];
+        }
+
+        void reset()
+        {
+            bins_.fill(empty_bin);
+        }
+
+        //
+        // merge from another set (union)
+        //
+
+        minhash &
+        operator+=(minhash const &other)
+        {
+            for(size_t i = 0; i < K; ++i)
+                bins_[i] = std::min(bins_[i], other.bins_[i]);
+            return *this;
+        }
+
+        constexpr size_t
+        size() const
+        {
+            return K;
+        }
+
+    private:
+
+        void insert_(uint64_t h)
+        {
+            auto &b = bins_[h & make_mask(bits)];
+            b = std::min(b, h >> bits);
+        }
+
+        std::array<uint64_t, K> bins_;
+        Hash hash_;
+    };
+
+
+    template <size_t K, typename Hash>
+    inline minhash<K, Hash>
+    operator+(minhash<K, Hash> lhs, minhash<K, Hash> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+    //
+    // Jaccard index from two b-bit signatures of K slots: a pair of slots
+    // also agrees by chance with probability 2^-B (for sets that are small
+    // compared to the hash range), hence J = (P - 2^-B) / (1 - 2^-B)
+    //
+
+    template <size_t K, size_t B, size_t N>
+    double bbit_jaccard(std::array<uint64_t, N> const &a, std::array<uint64_t, N> const &b)
+    {
+        static_assert(N == (K * B + 63) / 64, "bbit_jaccard: signature size mismatch!");
+
+        size_t eq = 0;
+        for(size_t i = 0; i < K; ++i)
+        {
+            auto x = (a[i * B / 64] >> (i * B % 64)) & make_mask(B);
+            auto y = (b[i * B / 64] >> (i * B % 64)) & make_mask(B);
+            eq += x == y;
+        }
+
+        auto r = std::ldexp(1.0, -static_cast<int>(B));
+        auto p = static_cast<double>(eq) / K;
+
+        return std::max(0.0, (p - r) / (1 - r));
+    }
+
+} // namespace pds
@@ -0,0 +1,398 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+
+#include <array>
+#include <algorithm>
+#include <iterator>
+#include <functional>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Reservoir sampling with geometric skips (Algorithm L):
+    //
+    // Li, K.-H. (1994). "Reservoir-Sampling Algorithms of Time Complexity
+    // O(n(1 + log(N/n)))".
+    //
+    // every sampled element carries a uniform key, the reservoir holds the K
+    // smallest ones and W is the largest: the number of elements to skip
+    // before the next one enters is geometric in W, so that the generator is
+    // only called on replacement (O(K log(N/K)) times), and the update is a
+    // single comparison otherwise. The entering element takes a key uniform
+    // in (0, W) and replaces the one with key W.
+    //
+    // Keeping the keys makes the reservoir mergeable: the union of two
+    // samples keeps the K smallest keys of both. Shards to be merged must be
+    // seeded differently.
+    //
+
+    template <typename T, size_t K>
+    struct reservoir
+    {
+        static_assert(K > 0, "reservoir: K must be positive!");
+
+        reservoir(uint64_t seed = 0x2545f4914f6cdd1dULL)
+        : rand_(seed)
+        { }
+
+        //
+        // offer an element
+        //
+
+        void update(T const &value)
+        {
+            if (++seen_ < next_)
+                return;
+
+            if (n_ < K)
+                fill_(value, open_uniform_());
+            else
+                replace_(value);
+        }
+
+        void operator()(T const &value)
+        {
+            update(value);
+        }
+
+        //
+        // offer a range: the skipped elements are jumped over
+        //
+
+        template <typename Iter>
+        void update(Iter it, Iter end)
+        {
+            while (it != end)
+            {
+                auto skip = std::min<uint64_t>(next_ - seen_ - 1, static_cast<uint64_t>(std::distance(it, end)));
+
+                std::advance(it, skip);
+                seen_ += skip;
+
+                if (it != end)
+                    update(*it++);
+            }
+        }
+
+        //
+        // number of the next elements that will be discarded
+        //
+
+        uint64_t skip() const
+        {
+            return next_ - seen_ - 1;
+        }
+
+        T const *begin() const { return items_.data(); }
+        T const *end()   const { return items_.data() + n_; }
+
+        size_t size() const
+        {
+            return n_;
+        }
+
+        uint64_t count() const
+        {
+            return seen_;
+        }
+
+        uint64_t eval() const
+        {
+            return seen_;
+        }
+
+        void reset()
+        {
+            n_ = 0;
+            seen_ = 0;
+            next_ = 1;
+            max_ = 0;
+        }
+
+        //
+        // merge another reservoir: the K smallest keys of both
+        //
+
+        reservoir &
+        operator+=(reservoir const &other)
+        {
+            seen_ += other.seen_;
+
+            for(size_t i = 0; i < other.n_; ++i)
+            {
+                if (n_ < K)
+                    fill_(other.items_[i], other.keys_[i]);
+                else if (other.keys_[i] < keys_[max_]) {
+                    items_[max_] = other.items_[i];
+                    keys_[max_]  = other.keys_[i];
+                    update_max_();
+                }
+            }
+
+            if (n_ < K)
+                next_ = seen_ + 1;
+            else
+                next_skip_();
+
+            return *this;
+        }
+
+    private:
+
+        double open_uniform_()
+        {
+            return 1.0 - rand_.uniform();
+        }
+
+        void fill_(T const &value, double key)
+        {
+            items_[n_] = value;
+            keys_[n_]  = key;
+            n_++;
+
+            if (n_ == K) {
+                update_max_();
+                next_skip_();
+            }
+            else
+                next_ = seen_ + 1;
+        }
+
+        void replace_(T const &value)
+        {
+            items_[max_] = value;
+            keys_[max_]  = keys_[max_] * open_uniform_();
+            update_max_();
+            next_skip_();
+        }
+
+        void update_max_()
+        {
+            max_ = static_cast<size_t>(std::max_element(std::begin(keys_), std::begin(keys_) + n_) - std::begin(keys_));
+        }
+
+        void next_skip_()
+        {
+            auto w = keys_[max_];
+            auto s = std::floor(std::log(open_uniform_()) / std::log1p(-w));
+
+            next_ = s < static_cast<double>(std::numeric_limits<uint64_t>::max() - seen_ - 1)
+                  ? seen_ + static_cast<uint64_t>(s) + 1
+                  : std::numeric_limits<uint64_t>::max();
+        }
+
+        std::array<T, K> items_;
+        std::array<double, K> keys_;
+        size_t n_ = 0;
+        size_t max_ = 0;
+
+        uint64_t seen_ = 0;
+        uint64_t next_ = 1;         // count at which the next element enters
+
+        xorshift64 rand_;
+    };
+
+
+    template <typename T, size_t K>
+    inline reservoir<T, K>
+    operator+(reservoir<T, K> lhs, reservoir<T, K> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+    //
+    // Priority sampling of weighted elements:
+    //
+    // Duffield, Lund, Thorup (2007). "Priority Sampling for Estimation of
+    // Arbitrary Subset Sums".
+    //
+    // an element of weight w has priority w / u, u uniform in (0,1]; the K
+    // highest priorities are kept, and the (K+1)-th is the threshold tau. The
+    // sum of the weights of any subset is estimated without bias by the sum
+    // of max(w, tau) over its sampled elements. The K+1 entries are a
+    // min-heap on the priority; samples merge by keeping the highest
+    // priorities of both.
+    //
+
+    template <typename T, size_t K>
+    struct priority_sample
+    {
+        static_assert(K > 0, "priority_sample: K must be positive!");
+
+        struct entry
+        {
+            T value;
+            double weight;
+            double priority;
+        };
+
+        priority_sample(uint64_t seed = 0x2545f4914f6cdd1dULL)
+        : rand_(seed)
+        { }
+
+        //
+        // offer an element with its weight (non-positive weights are ignored)
+        //
+
+        void update(T const &value, double weight)
+        {
+            seen_++;
+
+            if (!(weight > 0))
+                return;
+
+            push_(entry{ value, weight, weight / (1.0 - rand_.uniform()) });
+        }
+
+        void operator()(T const &value, double weight)
+        {
+            update(value, weight);
+        }
+
+        //
+        // threshold tau (0 until more than K elements have been offered)
+        //
+
+        double threshold() const
+        {
+            return n_ == K + 1 ? heap_[0].priority : 0.0;
+        }
+
+        //
+        // visit the samples: fun(value, weight, adjusted weight)
+        //
+
+        template <typename Fun>
+        void foreach_sample(Fun fun) const
+        {
+            auto tau = threshold();
+
+            for(size_t i = 0; i < n_; ++i)
+            {
+                if (n_ == K + 1 && i == 0)
+                    continue;
+                fun(heap_[i].value, heap_[i].weight, std::max(heap_[i].weight, tau));
+            }
+        }
+
+        //
+        // estimated sum of the weights of the elements satisfying pred
+        //
+
+        template <typename Pred>
+        double subset_sum(Pred pred) const
+        {
+            double ret = 0;
+            foreach_sample([&](T const &v, double, double adj) {
+                if (pred(v))
+                    ret += adj;
+            });
+            return ret;
+        }
+
+        double total() const
+        {
+            return subset_sum([](T const &) { return true; });
+        }
+
+        size_t size() const
+        {
+            return std::min(n_, K);
+        }
+
+        uint64_t count() const
+        {
+            return seen_;
+        }
+
+        uint64_t eval() const
+        {
+            return seen_;
+        }
+
+        void reset()
+        {
+            n_ = 0;
+            seen_ = 0;
+        }
+
+        priority_sample &
+        operator+=(priority_sample const &other)
+        {
+            seen_ += other.seen_;
+            for(size_t i = 0; i < other.n_; ++i)
+                push_(other.heap_[i]);
+            return *this;
+        }
+
+    private:
+
+        static bool greater_(entry const &a, entry const &b)
+        {
+            return a.priority > b.priority;
+        }
+
+        void push_(entry const &e)
+        {
+            if (n_ < K + 1) {
+                heap_[n_++] = e;
+                std::push_heap(std::begin(heap_), std::begin(heap_) + n_, greater_);
+                return;
+            }
+
+            if (e.priority <= heap_[0].priority)
+                return;
+
+            std::pop_heap(std::begin(heap_), std::end(heap_), greater_);
+            heap_[K] = e;
+            std::push_heap(std::begin(heap_), std::end(heap_), greater_);
+        }
+
+        std::array<entry, K + 1> heap_;
+        size_t n_ = 0;
+        uint64_t seen_ = 0;
+
+        xorshift64 rand_;
+    };
+
+
+    template <typename T, size_t K>
+    inline priority_sample<T, K>
+    operator+(priority_sample<T, K> lhs, priority_sample<T, K> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+} // namespace pds
@@ -32,18 +32,22 @@
 #include <pds/hash.hpp>
 #include <pds/tuple.hpp>
 #include <pds/range.hpp>
+#include <pds/bucket_set.hpp>
 
 #include <vector>
 #include <tuple>
 #include <iostream>
 #include <algorithm>
 #include <sstream>
-
-namespace pds {
-    
-    using Indices = std::vector<std::vector<size_t>>;
-}
-
+#include <numeric>
+#include <limits>
+#include <stdexcept>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <future>
+#include <thread>
 
 namespace std {
 
@@ -95,6 +99,35 @@ namespace pds {
         return make_optional(ids);
     }
 
+    //
+    // intersection of bucket sets: rows are checked first, so that failing
+    // merges (the vast majority in a cartesian expansion) do not allocate.
+    //
+
+    inline optional<bucket_set>
+    merge_indices(bucket_set const &s1, bucket_set const &s2, size_t tolerance = 0)
+    {
+        auto const & off = s1.layout->offset;
+
+        size_t null = 0;
+        for(size_t r = 0; r + 1 < off.size(); r++)
+        {
+            uint64_t any = 0;
+            for(auto i = off[r]; i < off[r+1]; ++i)
+                any |= s1.bits[i] & s2.bits[i];
+
+            if (!any && ++null > tolerance)
+                return nullopt;
+        }
+
+        bucket_set ret(s1.layout);
+
+        for(size_t i = 0; i < ret.bits.size(); ++i)
+            ret.bits[i] = s1.bits[i] & s2.bits[i];
+
+        return make_optional(std::move(ret));
+    }
+
     
     struct merge_annotated_
     {
@@ -114,45 +147,325 @@ namespace pds {
     auto constexpr merge_annotated = merge_annotated_{};
 
 
-    template < size_t J
-             , typename Sketch
-             , typename Range>
-    auto candidates( Sketch const &sketch
-                   , Range const &words
-                   , std::vector<std::vector<size_t>> const &buckets)
+    //
+    // inverse table of a sub-hash function over a range of words:
+    // for each hash value, the (sorted) list of its preimages.
+    // Ranges are limited to max_words (the table holds each word), so that
+    // offsets fit in 32 bits.
+    //
+
+    template <typename T>
+    struct inverse_table
     {
-        std::vector<annotated<typename Range::value_type, Indices>> ret;
+        static constexpr size_t max_words = 1 << 24;
 
-        std::cout << "+ candidates component[" << J << "]..." << std::endl;
+        template <typename Hash, typename Range>
+        inverse_table(Hash const &hf, size_t bits, Range const &words)
+        : offset_((1ULL << bits) + 1, 0)
+        {
+            std::vector<uint32_t> hs;
+
+            for(auto const &word : words)
+            {
+                if (hs.size() == max_words)
+                    throw std::length_error("inverse_table: range too large!");
+
+                auto h = static_cast<uint32_t>(hf(word) & make_mask(bits));
+                offset_[h+1]++;
+                hs.push_back(h);
+            }
+
+            std::partial_sum(std::begin(offset_), std::end(offset_), std::begin(offset_));
+
+            auto pos = offset_;
+            words_.resize(hs.size());
+
+            size_t n = 0;
+            for(auto const &word : words)
+                words_[pos[hs[n++]]++] = static_cast<T>(word);
+        }
+
+        size_t preimages(size_t h) const
+        {
+            return offset_[h+1] - offset_[h];
+        }
+
+        template <typename Fun>
+        void foreach_preimage(size_t h, Fun fun) const
+        {
+            for(auto i = offset_[h]; i < offset_[h+1]; ++i)
+                fun(words_[i]);
+        }
+
+    private:
+        std::vector<uint32_t> offset_;
+        std::vector<T> words_;
+    };
+
+    //
+    // number of words in a numeric range
+    //
+
+    template <typename T>
+    uintmax_t range_size(numeric_range<T> const &words)
+    {
+        if (words.max_ < words.min_)
+            return 0;
+        return static_cast<uintmax_t>(words.max_) - static_cast<uintmax_t>(words.min_) + 1;
+    }
+
+    //
+    // inverse tables are built once per (hash function type, range) and cached:
+    // hash functions are assumed to be stateless (fully determined by their type).
+    // The cache keeps the tables of the last few ranges only.
+    //
+
+    template <typename Hash, typename T>
+    std::shared_ptr<const inverse_table<T>>
+    get_inverse_table(Hash const &hf, numeric_range<T> const &words)
+    {
+        static constexpr size_t max_cached = 4;
+
+        static std::mutex mutex;
+        static std::map<std::pair<T, T>, std::shared_ptr<const inverse_table<T>>> cache;
+        static std::vector<std::pair<T, T>> order;
+
+        auto key = std::make_pair(words.min_, words.max_);
 
-        for(auto const &word: words)
         {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = cache.find(key);
+            if (it != std::end(cache))
+                return it->second;
+        }
+
+        // the table is built outside the lock: concurrent builds of the same
+        // range are possible, the first one inserted wins.
+
+        auto tab = std::make_shared<const inverse_table<T>>(hf, hash_bitsize<Hash>::value, words);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = cache.find(key);
+        if (it != std::end(cache))
+            return it->second;
+
+        if (order.size() == max_cached) {
+            cache.erase(order.front());
+            order.erase(std::begin(order));
+        }
+
+        order.push_back(key);
+        cache.emplace(key, tab);
+        return tab;
+    }
+
+
+    namespace details
+    {
+        //
+        // match the word against the buckets of each row, return the annotated
+        // candidate if it hits all the rows
+        //
+
+        template < size_t J
+                 , typename Sketch
+                 , typename T>
+        optional<annotated<T, bucket_set>>
+        match_candidate( Sketch const &sketch
+                       , T const &word
+                       , std::shared_ptr<const bucket_layout> const &layout)
+        {
+            auto const & buckets = layout->hot;
             size_t i = 0;
-            std::vector<std::vector<size_t>> total_indices;
 
-            pds::tuple_continue([&](auto &hash) { // row
+            pds::tuple_continue([&](auto &hash) { // row: test without allocating
 
                 auto & hf = hash.template sub_hash<J>();
-                auto & bidx = buckets[i]; 
-
-                auto indices = hash.template sub_match<J>(hf(word), bidx);
-                if (!indices.empty()) {
+                if (hash.template sub_matches<J>(hf(word), buckets[i])) {
                     i++;
-                    total_indices.push_back(std::move(indices));
                     return true;
                 }
-
                 return false;
 
             }, sketch.hash_);
 
             auto ts = std::tuple_size<decltype(sketch.hash_)>();
-            if (i == ts)  {
-                ret.emplace_back(static_cast<typename Range::value_type>(word), std::move(total_indices));
+            if (i != ts)
+                return nullopt;
+
+            i = 0;
+            bucket_set set(layout);
+
+            pds::tuple_foreach([&](auto &hash) { // row
+
+                using hash_t = std::decay_t<decltype(hash)>;
+                using sub_t  = typename hash_t::template sub_hash_type<J>;
+
+                size_t h = hash.template sub_hash<J>()(word) & make_mask(hash_bitsize<sub_t>::value);
+
+                auto & hot = buckets[i];
+                for(size_t p = 0; p < hot.size(); ++p)
+                {
+                    if (hash_t::template sub_value<J>(hot[p]) == h)
+                        set.set(i, p);
+                }
+                i++;
+
+            }, sketch.hash_);
+
+            return make_optional(annotated<T, bucket_set>(word, std::move(set)));
+        }
+
+        //
+        // brute force: match every word of the range
+        //
+
+        template < size_t J
+                 , typename Sketch
+                 , typename Range>
+        auto scan_candidates( Sketch const &sketch
+                            , Range const &words
+                            , std::vector<std::vector<size_t>> const &buckets)
+        {
+            std::vector<annotated<typename Range::value_type, bucket_set>> ret;
+
+            auto layout = std::make_shared<const bucket_layout>(buckets);
+
+            for(auto const &word: words)
+            {
+                if (auto c = match_candidate<J>(sketch, static_cast<typename Range::value_type>(word), layout))
+                    ret.push_back(std::move(*c));
             }
+
+            return ret;
         }
 
-        return ret;
+        //
+        // inverse table: only the preimages of the components of the buckets
+        // in the most selective row are matched
+        //
+
+        template < size_t J
+                 , typename Sketch
+                 , typename T>
+        auto table_candidates( Sketch const &sketch
+                             , numeric_range<T> const &words
+                             , std::vector<std::vector<size_t>> const &buckets)
+        {
+            std::vector<annotated<T, bucket_set>> ret;
+
+            auto layout = std::make_shared<const bucket_layout>(buckets);
+
+            std::vector<std::shared_ptr<const inverse_table<T>>> tables;
+            std::vector<std::vector<size_t>> values;
+
+            size_t best = 0, best_hits = std::numeric_limits<size_t>::max();
+
+            pds::tuple_foreach_index([&](auto I, auto &hash) { // row
+
+                using hash_t = std::decay_t<decltype(hash)>;
+
+                auto table = get_inverse_table(hash.template sub_hash<J>(), words);
+
+                std::vector<size_t> vs;
+                for(auto b : buckets.at(I))
+                    vs.push_back(hash_t::template sub_value<J>(b));
+
+                std::sort(std::begin(vs), std::end(vs));
+                vs.erase(std::unique(std::begin(vs), std::end(vs)), std::end(vs));
+
+                size_t hits = 0;
+                for(auto v : vs)
+                    hits += table->preimages(v);
+
+                if (hits < best_hits) {
+                    best = I;
+                    best_hits = hits;
+                }
+
+                tables.push_back(std::move(table));
+                values.push_back(std::move(vs));
+
+            }, sketch.hash_);
+
+            std::vector<T> hits;
+            hits.reserve(best_hits);
+
+            for(auto v : values[best])
+                tables[best]->foreach_preimage(v, [&](T word) { hits.push_back(word); });
+
+            std::sort(std::begin(hits), std::end(hits));
+
+            for(auto const &word : hits)
+            {
+                if (auto c = match_candidate<J>(sketch, word, layout))
+                    ret.push_back(std::move(*c));
+            }
+
+            return ret;
+        }
+
+        //
+        // inverse tables are used for sub-hash functions of up to 24 bits,
+        // and for ranges of up to inverse_table::max_words words (checked at runtime)
+        //
+
+        template <typename Hash, size_t J>
+        struct has_inverse_table
+        {
+            enum { value = hash_bitsize<typename Hash::template sub_hash_type<J>>::value <= 24 };
+        };
+
+        template <size_t J, typename Sketch, typename T>
+        auto dispatch_candidates(Sketch const &sketch, numeric_range<T> const &words,
+                                 std::vector<std::vector<size_t>> const &buckets, std::true_type)
+        {
+            if (range_size(words) > inverse_table<T>::max_words)
+                return scan_candidates<J>(sketch, words, buckets);
+
+            return table_candidates<J>(sketch, words, buckets);
+        }
+
+        template <size_t J, typename Sketch, typename T>
+        auto dispatch_candidates(Sketch const &sketch, numeric_range<T> const &words,
+                                 std::vector<std::vector<size_t>> const &buckets, std::false_type)
+        {
+            return scan_candidates<J>(sketch, words, buckets);
+        }
+
+    } // namespace details
+
+
+    template < size_t J
+             , typename Sketch
+             , typename Range>
+    auto candidates( Sketch const &sketch
+                   , Range const &words
+                   , std::vector<std::vector<size_t>> const &buckets)
+    {
+        std::cout << "+ candidates component[" << J << "]..." << std::endl;
+
+        return details::scan_candidates<J>(sketch, words, buckets);
+    }
+
+    //
+    // numeric ranges are reversed by means of the inverse tables of the sub-hash functions
+    //
+
+    template < size_t J
+             , typename Sketch
+             , typename T>
+    auto candidates( Sketch const &sketch
+                   , numeric_range<T> const &words
+                   , std::vector<std::vector<size_t>> const &buckets)
+    {
+        using hash_t = std::decay_t<decltype(std::get<0>(sketch.hash_))>;
+
+        std::cout << "+ candidates component[" << J << "]..." << std::endl;
+
+        return details::dispatch_candidates<J>(sketch, words, buckets,
+                    std::integral_constant<bool, details::has_inverse_table<hash_t, J>::value>{});
     }
 
     
@@ -172,6 +485,24 @@ namespace pds {
                                       , buckets)...);
         }
 
+        template < typename Sketch
+                 , typename ... Ranges
+                 , size_t ... I>
+        auto parallel_all_candidates( Sketch const &sketch
+                                    , std::tuple<Ranges...> const &words
+                                    , std::vector<std::vector<size_t>> const &buckets
+                                    , std::index_sequence<I...>)
+        {
+            auto fs = std::make_tuple(
+                        std::async(std::launch::async, [&] {
+                            return pds::candidates<I>( sketch
+                                                     , std::get<I>(words)
+                                                     , buckets);
+                        })...);
+
+            return std::make_tuple(std::get<I>(fs).get()...);
+        }
+
     } // namespace detail
 
     template < typename Sketch
@@ -187,6 +518,32 @@ namespace pds {
     }                    
 
 
+    //
+    // reverse the sketch: the candidates of the components are joined depth-first,
+    // a partial key is dropped as soon as its buckets do not intersect, and each
+    // key that survives is passed to the callback annotated with its indexes.
+    //
+
+    template < typename ...Ts, typename Sketch, typename Fun >
+    void foreach_reverse_sketch( Sketch const &sketch
+                               , std::vector<std::vector<size_t>> const &buckets
+                               , Fun fun)
+    {
+        auto res = all_candidates( sketch
+                                 , std::make_tuple( pds::make_range<Ts>::run()...)
+                                 , buckets);
+
+        foreach_cartesian_product_by(res, pds::merge_annotated, [&](auto const &c) {
+            fun(annotate(c.value, c.info.to_indices()));
+        });
+    }
+
+    namespace details
+    {
+        template <typename Cands>
+        using reversed_t = annotated<decltype(std::declval<cartesian_product_type_t<merge_annotated_, Cands>>().value), Indices>;
+    }
+
     template < typename ...Ts, typename Sketch >
     auto reverse_sketch( Sketch const &sketch
                        , std::vector<std::vector<size_t>> const &buckets)
@@ -195,7 +552,78 @@ namespace pds {
                                  , std::make_tuple( pds::make_range<Ts>::run()...)
                                  , buckets);
 
-        return expand_cartesian_product_by(res, pds::merge_annotated);
+        std::vector<details::reversed_t<decltype(res)>> ret;
+
+        foreach_cartesian_product_by(res, pds::merge_annotated, [&](auto const &c) {
+            ret.emplace_back(c.value, c.info.to_indices());
+        });
+
+        return ret;
+    } 
+
+    //
+    // parallel reversing: candidates of each component are generated by
+    // concurrent tasks, the cartesian expansion is split in chunks of the
+    // product of the first components, as many as needed to feed all the
+    // threads.
+    //
+
+    template < typename Sketch
+             , typename ... Ranges>
+    auto parallel_all_candidates( Sketch const &sketch
+                                , std::tuple<Ranges...> const &words
+                                , std::vector<std::vector<size_t>> const &buckets)
+    {
+        return detail::parallel_all_candidates( sketch
+                                              , words
+                                              , buckets
+                                              , std::make_index_sequence<sizeof...(Ranges)>{});
+    }                    
+
+
+    template < typename ...Ts, typename Sketch >
+    auto parallel_reverse_sketch( Sketch const &sketch
+                                , std::vector<std::vector<size_t>> const &buckets
+                                , size_t threads = std::thread::hardware_concurrency())
+    {
+        auto res = parallel_all_candidates( sketch
+                                          , std::make_tuple( pds::make_range<Ts>::run()...)
+                                          , buckets);
+
+        using R = details::reversed_t<decltype(res)>;
+
+        threads = std::max<size_t>(threads, 1);
+
+        size_t depth = 1, size = cartesian_prefix_size(res, 1);
+        while (size < threads && depth < std::tuple_size<decltype(res)>::value)
+            size = cartesian_prefix_size(res, ++depth);
+
+        auto chunk = (size + threads - 1) / threads;
+
+        std::vector<std::future<std::vector<R>>> parts;
+
+        for(size_t b = 0; b < size; b += chunk)
+        {
+            parts.push_back(std::async(threads < 2 ? std::launch::deferred : std::launch::async, [&, b]
+            {
+                std::vector<R> vec;
+                foreach_cartesian_product_by(res, pds::merge_annotated, [&](auto const &c) {
+                    vec.emplace_back(c.value, c.info.to_indices());
+                }, b, b + chunk, depth);
+                return vec;
+            }));
+        }
+
+        std::vector<R> ret;
+
+        for(auto &f : parts)
+        {
+            auto part = f.get();
+            ret.insert(std::end(ret), std::make_move_iterator(std::begin(part)),
+                                      std::make_move_iterator(std::end(part)));
+        }
+
+        return ret;
     } 
 
 
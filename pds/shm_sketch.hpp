@@ -0,0 +1,371 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+#include <pds/tuple.hpp>
+#include <pds/hash.hpp>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <cerrno>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Shared-memory sketch:
+    //
+    // the counters of a count-min sketch are placed in a POSIX shared memory
+    // segment, so that a producer process can update them while any number of
+    // reader processes run count(), indexes() and reverse_sketch() directly on
+    // the mapped table. Counters are lock-free atomics updated with relaxed
+    // ordering: readers never observe torn counters, while a snapshot of the
+    // whole table is not atomic with respect to concurrent updates.
+    //
+
+    enum class shm_mode
+    {
+        create,     // create (or truncate) the segment, read-write
+        open,       // attach to an existing segment, read-write
+        read_only   // attach to an existing segment, read-only
+    };
+
+    template <typename T, std::size_t W, typename ...Hs>
+    struct shm_sketch
+    {
+        static_assert(details::hash_coherence<pds::hash_rank, Hs...>::value,        "shm_sketch: all hash functions must have the same rank (number of hash component)!");
+        static_assert(details::hash_coherence<pds::hash_bitsize, Hs...>::value,     "shm_sketch: all hash functions must have the same co-domain size!");
+        static_assert((1ULL << pds::hash_bitsize<type_at_t<0, Hs...>>::value) == W, "shm_sketch: W and co-domain size mismatch!");
+        static_assert(std::is_integral<T>::value,                                   "shm_sketch: counters must be of integral type!");
+        static_assert(sizeof(std::atomic<T>) == sizeof(T),                          "shm_sketch: atomic counters must have the size of T!");
+
+        using atomic_type = std::atomic<T>;
+
+        //
+        // layout of the segment: a header followed by the (rows x W) table
+        //
+
+        struct header
+        {
+            uint64_t magic;
+            uint64_t rows;
+            uint64_t width;
+            uint64_t cell;
+        };
+
+        static constexpr uint64_t magic = 0x7064732d73686d31ULL; // "pds-shm1"
+
+        static constexpr size_t
+        segment_size()
+        {
+            return sizeof(header) + sizeof...(Hs) * W * sizeof(atomic_type);
+        }
+
+        template <typename ...Xs>
+        shm_sketch(std::string name, shm_mode mode = shm_mode::open, Xs ... xs)
+        : name_(std::move(name))
+        , mode_(mode)
+        , hash_(pds::make_tuple<Hs...>(xs...))
+        {
+            int flags = mode == shm_mode::create    ? (O_CREAT | O_RDWR) :
+                        mode == shm_mode::read_only ? O_RDONLY : O_RDWR;
+
+            int fd = ::shm_open(name_.c_str(), flags, 0600);
+            if (fd == -1)
+                throw std::system_error(errno, std::generic_category(), "shm_sketch: shm_open(" + name_ + ")");
+
+            if (mode == shm_mode::create) {
+                if (::ftruncate(fd, segment_size()) == -1) {
+                    auto err = errno;
+                    ::close(fd);
+                    throw std::system_error(err, std::generic_category(), "shm_sketch: ftruncate");
+                }
+            }
+            else {
+                struct stat st;
+                if (::fstat(fd, &st) == -1 || static_cast<size_t>(st.st_size) != segment_size()) {
+                    ::close(fd);
+                    throw std::runtime_error("shm_sketch: " + name_ + ": segment size mismatch!");
+                }
+            }
+
+            int prot = mode == shm_mode::read_only ? PROT_READ : (PROT_READ | PROT_WRITE);
+
+            addr_ = ::mmap(nullptr, segment_size(), prot, MAP_SHARED, fd, 0);
+            ::close(fd);
+
+            if (addr_ == MAP_FAILED)
+                throw std::system_error(errno, std::generic_category(), "shm_sketch: mmap");
+
+            auto hdr = static_cast<header *>(addr_);
+            data_ = reinterpret_cast<atomic_type *>(hdr + 1);
+
+            if (mode == shm_mode::create)
+            {
+                for(size_t n = 0; n < sizeof...(Hs) * W; ++n)
+                    new (data_ + n) atomic_type(T{});
+
+                hdr->rows  = sizeof...(Hs);
+                hdr->width = W;
+                hdr->cell  = sizeof(T);
+                std::atomic_thread_fence(std::memory_order_release);
+                hdr->magic = magic;
+            }
+            else if (hdr->magic != magic || hdr->rows  != sizeof...(Hs) ||
+                     hdr->width != W     || hdr->cell  != sizeof(T))
+            {
+                ::munmap(addr_, segment_size());
+                throw std::runtime_error("shm_sketch: " + name_ + ": incompatible segment layout!");
+            }
+        }
+
+        shm_sketch(shm_sketch const &) = delete;
+        shm_sketch& operator=(shm_sketch const &) = delete;
+
+        shm_sketch(shm_sketch &&other) noexcept
+        : name_(std::move(other.name_))
+        , mode_(other.mode_)
+        , addr_(other.addr_)
+        , data_(other.data_)
+        , hash_(std::move(other.hash_))
+        {
+            other.addr_ = MAP_FAILED;
+            other.data_ = nullptr;
+        }
+
+        ~shm_sketch()
+        {
+            if (addr_ != MAP_FAILED)
+                ::munmap(addr_, segment_size());
+        }
+
+        //
+        // remove the segment name (mappings stay valid until unmapped)
+        //
+
+        static void
+        unlink(std::string const &name)
+        {
+            ::shm_unlink(name.c_str());
+        }
+
+        //
+        // foreach bucket...
+        //
+
+        template <typename Tp, typename Fun>
+        void foreach_bucket(Tp const &elem, Fun action) const
+        {
+            foreach_(elem, action, std::make_index_sequence<sizeof...(Hs)>());
+        }
+
+        //
+        // increment/decrement buckets
+        //
+
+        template <typename Tp>
+        void increment_buckets(Tp const &elem, T value = 1)
+        {
+            foreach_bucket(elem, [=](atomic_type &bucket) { bucket.fetch_add(value, std::memory_order_relaxed); });
+        }
+
+        template <typename Tp>
+        void decrement_buckets(Tp const &elem, T value = 1)
+        {
+            foreach_bucket(elem, [=](atomic_type &bucket) { bucket.fetch_sub(value, std::memory_order_relaxed); });
+        }
+
+        //
+        // count min estimation
+        //
+
+        template <typename Tp>
+        T count(Tp const &elem) const
+        {
+            T n = std::numeric_limits<T>::max();
+
+            foreach_bucket(elem, [&](atomic_type const &bucket) {
+                n = std::min(n, bucket.load(std::memory_order_relaxed));
+            });
+
+            return n;
+        }
+
+        //
+        // given the element, return the corresponding buckets
+        //
+
+        template <typename Tp>
+        auto buckets(Tp const &elem) const
+        {
+            std::vector<T> ret;
+
+            foreach_bucket(elem, [&](atomic_type const &bucket) {
+                ret.push_back(bucket.load(std::memory_order_relaxed));
+            });
+
+            return ret;
+        }
+
+        //
+        // given a matrix of indexes, return the corresponding buckets
+        //
+
+        auto buckets(std::vector<std::vector<size_t>> const &idx) const
+        {
+            std::vector<T> ret;
+            size_t n = 0;
+
+            for(auto const &r : idx)
+            {
+                for(auto i : r)
+                    ret.push_back((*this)(n, i));
+                n++;
+            }
+
+            return ret;
+        }
+
+        //
+        // return the indexes of buckets whose value holds the given predicate.
+        // to the predicate are passed the bucket and the minimum, across rows,
+        // of the sum of the values of all buckets in the row.
+        //
+
+        uint64_t minsum() const
+        {
+            uint64_t sum = std::numeric_limits<uint64_t>::max();
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                uint64_t row = 0;
+                for(size_t c = 0; c < W; ++c)
+                    row += (*this)(r, c);
+                sum = std::min(sum, row);
+            }
+
+            return sum;
+        }
+
+        template <typename Fun>
+        auto indexes(Fun pred) const
+        {
+            std::vector<std::vector<size_t>> ret;
+
+            auto sum = minsum();
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                std::vector<size_t> row;
+                for(size_t c = 0; c < W; ++c)
+                {
+                    if (pred((*this)(r, c), sum))
+                        row.push_back(c);
+                }
+                ret.push_back(std::move(row));
+            }
+
+            return ret;
+        }
+
+        //
+        // reset all buckets in the sketch
+        //
+
+        void
+        reset()
+        {
+            for(size_t n = 0; n < sizeof...(Hs) * W; ++n)
+                data_[n].store(T{}, std::memory_order_relaxed);
+        }
+
+        //
+        // load the value of a bucket
+        //
+
+        T operator()(size_t r, size_t c) const
+        {
+            return data_[r * W + c].load(std::memory_order_relaxed);
+        }
+
+        //
+        // copy the shared table into a local sketch
+        //
+
+        sketch<T, W, Hs...>
+        snapshot() const
+        {
+            sketch<T, W, Hs...> ret;
+            ret.hash_ = hash_;
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+                for(size_t c = 0; c < W; ++c)
+                    ret.data_[r][c] = (*this)(r, c);
+
+            return ret;
+        }
+
+        constexpr inline std::pair<size_t, size_t>
+        size() const
+        {
+            return std::make_pair(sizeof...(Hs), W);
+        }
+
+        std::string const &
+        name() const
+        {
+            return name_;
+        }
+
+        template <typename Tp, typename Fun, size_t ...N>
+        void foreach_(Tp const &elem, Fun action, std::index_sequence<N...>) const
+        {
+            auto sink = { (action(data_[N * W + std::get<N>(hash_)(elem) % W]),0)... };
+            (void)sink;
+        }
+
+        std::string name_;
+        shm_mode mode_;
+        void *addr_ = MAP_FAILED;
+        atomic_type *data_ = nullptr;
+
+        std::tuple<Hs...> hash_;
+    };
+
+} // namespace pds
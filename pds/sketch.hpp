@@ -32,6 +32,7 @@
 #include <pds/eval.hpp>
 
 #include <cstddef>
+#include <array>
 #include <utility>
 #include <vector>
 #include <limits>
@@ -135,6 +136,17 @@ namespace pds {
         }
 
 
+        //
+        // given the element, return the index of its bucket in each row
+        //
+
+        template <typename Tp>
+        std::array<size_t, sizeof...(Hs)>
+        bucket_indexes(Tp const &elem) const
+        {
+            return bucket_indexes_(elem, std::make_index_sequence<sizeof...(Hs)>());
+        }
+
         //
         // increment buckets
         //
@@ -210,35 +222,47 @@ namespace pds {
         }
 
         //
-        // return the indexes of buckets whose value holds the given predicate. 
-        // to the predicate are passed the bucket and the sum of the values of all
-	// buckets in the same row. 
+        // return the sum of the (evaluated) buckets of each row
         //
 
-	uint64_t minsum() const
-	{
-	    uint64_t sum = std::numeric_limits<uint64_t>::max(); 
-	    uint64_t row;
-            for(auto & r : data_) {
-		row = 0;
-		for(auto & e : r)  {
-			auto value = eval(e);
-			row += value;
-		}
+        std::array<uint64_t, sizeof...(Hs)>
+        row_sums() const
+        {
+            std::array<uint64_t, sizeof...(Hs)> ret;
 
-		sum = std::min(sum, row);
-	    }
-	    return sum;
-	}
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                uint64_t row = 0;
+                for(auto & e : data_[r])
+                    row += eval(e);
+                ret[r] = row;
+            }
+
+            return ret;
+        }
+
+        //
+        // return the indexes of buckets whose value holds the given predicate. 
+        // to the predicate are passed the bucket and the minimum, across rows,
+        // of the sum of the values of all buckets in the row.
+        //
+
+        uint64_t minsum() const
+        {
+            auto sums = row_sums();
+            return *std::min_element(std::begin(sums), std::end(sums));
+        }
  
         template <typename Fun>
         auto indexes(Fun pred) const
         {
             std::vector<std::vector<size_t>> ret;
 
+            auto sum = minsum();
+
             for(auto & v : data_) {
                 std::vector<size_t> row;
-		size_t c = 0, sum = minsum(); 
+                size_t c = 0;
 
                 for(auto & e : v) {
                     if (pred(e, sum))
@@ -250,6 +274,7 @@ namespace pds {
 
             return ret;
         }
+
         //
         // filter the keys whose the given predicate holds for each
         // bucket
@@ -296,7 +321,7 @@ namespace pds {
 
             double sum = std::accumulate(std::begin(data_[0]),
                                          std::end(data_[0]),
-                                         size_t{0});
+                                         0.0);
 
             foreach_bucket(elem, [&](T const &bucket) {
                 auto va_ = (bucket - sum/W)/(1.0 - 1.0/W);
@@ -369,6 +394,30 @@ namespace pds {
             return *this;
         }
 
+        //
+        // subtract another sketch
+        //
+
+        sketch &
+        operator-=(sketch const &other)
+        {
+            for(size_t i = 0; i < sizeof...(Hs); ++i)
+            {
+                auto & lhs = data_[i];
+                auto & rhs = other.data_[i];
+                for(size_t j = 0; j < W; ++j)
+                    lhs[j] -= rhs[j];
+            }
+            return *this;
+        }
+
+        template <typename Tp, size_t ...N>
+        std::array<size_t, sizeof...(Hs)>
+        bucket_indexes_(Tp const &elem, std::index_sequence<N...>) const
+        {
+            return {{ (std::get<N>(hash_)(elem) % W)... }};
+        }
+
         template <typename Tp, typename Fun, size_t ...N>
         bool continuation_(Tp const &elem, Fun action, std::index_sequence<N...>)
         {
@@ -406,4 +455,30 @@ namespace pds {
         return lhs += rhs;
     }
 
+    template <typename T, std::size_t W, typename ...Hs>
+    inline sketch<T, W, Hs...> 
+    operator-(sketch<T, W, Hs...> lhs, sketch<T, W, Hs...> const &rhs)
+    {
+        return lhs -= rhs;
+    }
+
+    //
+    // in-place element-wise kernel over sketches of the same shape (the
+    // type of the buckets may differ): fun is called with the buckets at
+    // the same position of each sketch, e.g. to compute a linear combination
+    // without temporary sketches.
+    //
+
+    template <typename Fun, typename T, std::size_t W, typename ...Hs, typename ...Ss>
+    inline void
+    zip_apply(Fun fun, sketch<T, W, Hs...> &lhs, Ss && ...others)
+    {
+        for(size_t i = 0; i < sizeof...(Hs); ++i)
+        {
+            auto & row = lhs.data_[i];
+            for(size_t j = 0; j < W; ++j)
+                fun(row[j], others.data_[i][j]...);
+        }
+    }
+
 } // namespace pds
@@ -0,0 +1,218 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/eval.hpp>
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+#include <limits>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Sketch query:
+    //
+    // evaluates once all the buckets of a sketch (or of any structure with
+    // size() and operator()(row, col), e.g. shm_sketch or an epoch snapshot)
+    // and the sums of its rows. Threshold scans like indexes() are then a
+    // single O(d*W) pass over the evaluated values, instead of evaluating the
+    // cells (a HyperLogLog estimation each, for sketch<HLL>) again for every
+    // predicate.
+    //
+    // The query is immutable: build one per closed interval (e.g. per epoch
+    // snapshot) and share it among readers. It refers to the sketch, which
+    // must outlive it.
+    //
+
+    template <typename Sketch>
+    struct sketch_query
+    {
+        using cell_type  = std::decay_t<decltype(std::declval<Sketch const &>()(0,0))>;
+        using value_type = std::decay_t<decltype(eval(std::declval<cell_type const &>()))>;
+
+        explicit sketch_query(Sketch const &s)
+        : sketch_(s)
+        , rows_(s.size().first)
+        , width_(s.size().second)
+        , values_(rows_ * width_)
+        , sums_(rows_)
+        {
+            evaluate_(std::is_arithmetic<cell_type>{});
+
+            minsum_ = rows_ ? *std::min_element(std::begin(sums_), std::end(sums_)) : 0;
+        }
+
+        //
+        // evaluated bucket
+        //
+
+        value_type
+        operator()(size_t r, size_t c) const
+        {
+            return values_[r * width_ + c];
+        }
+
+        //
+        // given a matrix of indexes, return the corresponding evaluated buckets
+        //
+
+        auto buckets(std::vector<std::vector<size_t>> const &idx) const
+        {
+            std::vector<value_type> ret;
+            size_t n = 0;
+
+            for(auto const &r : idx)
+            {
+                for(auto i : r)
+                    ret.push_back((*this)(n, i));
+                n++;
+            }
+
+            return ret;
+        }
+
+        std::vector<uint64_t> const &
+        row_sums() const
+        {
+            return sums_;
+        }
+
+        uint64_t
+        minsum() const
+        {
+            return minsum_;
+        }
+
+        //
+        // return the indexes of buckets whose evaluated value holds the given
+        // predicate. To the predicate are passed the value and the minimum,
+        // across rows, of the sum of the values of the row.
+        //
+
+        template <typename Fun>
+        auto indexes(Fun pred) const
+        {
+            std::vector<std::vector<size_t>> ret(rows_);
+
+            for(size_t r = 0; r < rows_; ++r)
+            {
+                auto row = values_.data() + r * width_;
+                for(size_t c = 0; c < width_; ++c)
+                {
+                    if (pred(row[c], minsum_))
+                        ret[r].push_back(c);
+                }
+            }
+
+            return ret;
+        }
+
+        Sketch const &
+        sketch() const
+        {
+            return sketch_;
+        }
+
+        std::pair<size_t, size_t>
+        size() const
+        {
+            return std::make_pair(rows_, width_);
+        }
+
+    private:
+
+        //
+        // arithmetic cells: plain copy and sum of each row (vectorizable loops)
+        //
+
+        void evaluate_(std::true_type)
+        {
+            for(size_t r = 0; r < rows_; ++r)
+            {
+                auto row = values_.data() + r * width_;
+
+                copy_row_(r, row, std::is_lvalue_reference<decltype(sketch_(r, 0))>{});
+
+                sums_[r] = std::accumulate(row, row + width_, uint64_t{0});
+            }
+        }
+
+        void copy_row_(size_t r, value_type *row, std::true_type)
+        {
+            auto src = &sketch_(r, 0);  // rows are contiguous
+            std::copy(src, src + width_, row);
+        }
+
+        void copy_row_(size_t r, value_type *row, std::false_type)
+        {
+            for(size_t c = 0; c < width_; ++c)
+                row[c] = sketch_(r, c);
+        }
+
+        //
+        // other cells: one evaluation each
+        //
+
+        void evaluate_(std::false_type)
+        {
+            for(size_t r = 0; r < rows_; ++r)
+            {
+                uint64_t sum = 0;
+                auto row = values_.data() + r * width_;
+                for(size_t c = 0; c < width_; ++c)
+                {
+                    row[c] = eval(sketch_(r, c));
+                    sum += row[c];
+                }
+                sums_[r] = sum;
+            }
+        }
+
+        Sketch const &sketch_;
+
+        size_t rows_;
+        size_t width_;
+
+        std::vector<value_type> values_;
+        std::vector<uint64_t>   sums_;
+        uint64_t                minsum_;
+    };
+
+
+    template <typename Sketch>
+    sketch_query<Sketch>
+    make_query(Sketch const &s)
+    {
+        return sketch_query<Sketch>(s);
+    }
+
+} // namespace pds
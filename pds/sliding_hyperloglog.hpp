@@ -0,0 +1,258 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+#include <pds/hash.hpp>
+#include <pds/hyperloglog.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdint>
+#include <cstddef>
+
+
+namespace pds {
+
+    ///////////////////////////////////////////////////////////////////////////////
+    //
+    // Sliding HyperLogLog
+    //
+    // Chabchoub, Y.; Hebrail, G. (2010). "Sliding HyperLogLog: Estimating
+    // cardinality in a data stream over a sliding window".
+    // 2010 IEEE International Conference on Data Mining Workshops, pp. 1297–1303.
+    //
+    // Each register keeps the List of Future Possible Maxima (LPFM): the pairs
+    // (time, rank) that can still be the maximum of a window ending now or later.
+    // The list is ordered by time with strictly decreasing ranks, therefore the
+    // value of a register for any window up to the limit W is the rank of the
+    // first entry falling in the window.
+    //
+    // Timestamps are expected in non-decreasing order (late elements are
+    // accounted at the latest time seen). The time unit is up to the user.
+    //
+
+    template <size_t M, typename Hash, uint64_t W>
+    struct sliding_hyperloglog
+    {
+        constexpr static size_t K = log2(M);
+        constexpr static size_t L = hash_bitsize<Hash>::value;
+
+        static_assert((M&(M-1)) == 0, "SHLL: groups (m) must be a power of two");
+        static_assert(L-K > 5,        "SHLL: the hash_bitsize must be reasonably greater than K (L-K > 5)");
+        static_assert(W > 0,          "SHLL: the window limit must be positive");
+
+        struct entry
+        {
+            uint64_t time;
+            uint8_t  rank;
+        };
+
+        template <typename X = Hash>
+        sliding_hyperloglog(X x = X())
+        : lpfm_(M)
+        , hash_(x)
+        { }
+
+        //
+        // hash and process the element seen at the given time:
+        //
+
+        template <typename T>
+        void operator()(T const &elem, uint64_t time)
+        {
+            auto h = hash_(elem);
+            auto j = h & make_mask(K);
+            auto v = h >> K;
+
+            uint8_t r = rank(v);
+
+            now_ = std::max(now_, time);
+
+            auto & l = lpfm_[j];
+
+            // older entries with a lower or equal rank will never be a maximum again
+
+            while (!l.empty() && l.back().rank <= r)
+                l.pop_back();
+
+            l.push_back(entry{now_, r});
+
+            expire_(l);
+        }
+
+        //
+        // estimated number of distinct elements in the last 'window' time units,
+        // ending at 'now' (default: the latest time seen). Only windows ending
+        // at the latest time seen, or later (no further elements), can be
+        // answered: the entries superseded by later and higher ranks are gone,
+        // so an earlier 'now' throws std::invalid_argument.
+        //
+
+        double cardinality(uint64_t window, uint64_t now) const
+        {
+            if (now < now_)
+                throw std::invalid_argument("SHLL: window ending before the latest time seen!");
+
+            std::vector<uint8_t> regs(M);
+
+            window = std::min(window, W);
+
+            for(size_t n = 0; n < M; n++)
+            {
+                for(auto const & e : lpfm_[n])
+                {
+                    if (e.time <= now && e.time + window > now) {
+                        regs[n] = e.rank;
+                        break;
+                    }
+                }
+            }
+
+            return hll_estimate<M, L>(std::begin(regs), std::end(regs));
+        }
+
+        double cardinality(uint64_t window) const
+        {
+            return cardinality(window, now_);
+        }
+
+        double cardinality() const
+        {
+            return cardinality(W, now_);
+        }
+
+	double eval() const
+	{
+	    return this->cardinality();
+	}
+
+        //
+        // drop the entries out of the window limit at the given time
+        //
+
+        void
+        expire(uint64_t time)
+        {
+            now_ = std::max(now_, time);
+            for(auto & l : lpfm_)
+                expire_(l);
+        }
+
+        uint64_t
+        time() const
+        {
+            return now_;
+        }
+
+        //
+        // merge from another counter
+        //
+
+        sliding_hyperloglog &
+        operator+=(sliding_hyperloglog const &other)
+        {
+            now_ = std::max(now_, other.now_);
+
+            std::vector<entry> tmp;
+
+            for(size_t n = 0; n < M; n++)
+            {
+                auto & l = lpfm_[n];
+                auto & r = other.lpfm_[n];
+
+                tmp.clear();
+                std::merge(std::begin(l), std::end(l), std::begin(r), std::end(r), std::back_inserter(tmp),
+                           [](entry const &a, entry const &b) { return a.time < b.time; });
+
+                // rebuild the LPFM from the most recent entry backwards...
+
+                l.clear();
+                uint8_t max = 0;
+                for(auto it = tmp.rbegin(); it != tmp.rend(); ++it)
+                {
+                    if (l.empty() || it->rank > max) {
+                        l.push_back(*it);
+                        max = it->rank;
+                    }
+                }
+
+                std::reverse(std::begin(l), std::end(l));
+                expire_(l);
+            }
+
+            return *this;
+        }
+
+        //
+        // reset counter
+        //
+
+        void
+        reset()
+        {
+            for(auto & l : lpfm_)
+                l.clear();
+            now_ = 0;
+        }
+
+        constexpr size_t
+        size() const
+        {
+            return M;
+        }
+
+    private:
+
+        void
+        expire_(std::vector<entry> &l) const
+        {
+            if (now_ < W)
+                return;
+
+            auto it = std::find_if(std::begin(l), std::end(l), [&](entry const &e) {
+                                    return e.time > now_ - W;
+                                  });
+
+            l.erase(std::begin(l), it);
+        }
+
+        std::vector<std::vector<entry>> lpfm_;
+        uint64_t now_ = 0;
+        Hash hash_;
+    };
+
+
+    template <size_t M, typename Hash, uint64_t W>
+    inline sliding_hyperloglog<M, Hash, W>
+    operator+(sliding_hyperloglog<M, Hash, W> lhs, sliding_hyperloglog<M, Hash, W> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+}  // namespace pds
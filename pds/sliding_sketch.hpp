@@ -0,0 +1,216 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace pds {
+
+    //
+    // Sliding-window sketch:
+    //
+    // the window is split into N sub-intervals, each one recorded by its own
+    // sub-sketch; a running aggregate holds the sum of the N sub-sketches and
+    // answers every query. Updates touch the current sub-sketch and the
+    // aggregate (hashing the element once), while advance() subtracts the
+    // expiring sub-sketch from the aggregate and recycles it: the cost of
+    // sliding is paid once per sub-interval rather than per query.
+    //
+    // The aggregate is a pds::sketch sharing the hash functions of the
+    // sub-sketches, so it can be passed to reverse_sketch() as it is.
+    //
+
+    template <typename T, std::size_t W, std::size_t N, typename ...Hs>
+    struct sliding_sketch
+    {
+        static_assert(N > 0, "sliding_sketch: the window needs at least one sub-interval!");
+        static_assert(std::is_arithmetic<T>::value, "sliding_sketch: the running aggregate requires arithmetic counters!");
+
+        using sketch_type = sketch<T, W, Hs...>;
+
+        template <typename ...Xs>
+        sliding_sketch(Xs ... xs)
+        : window_(xs...)
+        , slots_(N, window_)
+        { }
+
+        //
+        // update the current sub-interval (and the window)
+        //
+
+        template <typename Tp>
+        void increment_buckets(Tp const &elem, T value = 1)
+        {
+            auto idx = window_.bucket_indexes(elem);
+            auto & cur = slots_[current_];
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                cur.data_[r][idx[r]] += value;
+                window_.data_[r][idx[r]] += value;
+            }
+        }
+
+        template <typename Tp>
+        void decrement_buckets(Tp const &elem, T value = 1)
+        {
+            auto idx = window_.bucket_indexes(elem);
+            auto & cur = slots_[current_];
+
+            for(size_t r = 0; r < sizeof...(Hs); ++r)
+            {
+                cur.data_[r][idx[r]] -= value;
+                window_.data_[r][idx[r]] -= value;
+            }
+        }
+
+        //
+        // slide the window by n sub-intervals:
+        // the oldest sub-intervals expire and are removed from the aggregate.
+        //
+
+        void
+        advance(size_t n = 1)
+        {
+            tick_ += n;
+
+            if (n >= N) {
+                reset_();
+                return;
+            }
+
+            for(size_t i = 0; i < n; ++i)
+            {
+                current_ = (current_ + 1) % N;
+                window_ -= slots_[current_];
+                slots_[current_].reset();
+            }
+        }
+
+        //
+        // slide the window up to the given sub-interval number
+        // (e.g. timestamp / sub-interval length)
+        //
+
+        void
+        advance_to(uint64_t tick)
+        {
+            if (tick > tick_)
+                advance(tick - tick_);
+        }
+
+        uint64_t
+        tick() const
+        {
+            return tick_;
+        }
+
+        //
+        // queries over the window...
+        //
+
+        template <typename Tp>
+        T count(Tp const &elem) const
+        {
+            return window_.count(elem);
+        }
+
+        template <typename Tp>
+        double estimate(Tp const &elem) const
+        {
+            return window_.estimate(elem);
+        }
+
+        template <typename Tp>
+        auto buckets(Tp const &elem) const
+        {
+            return window_.buckets(elem);
+        }
+
+        uint64_t minsum() const
+        {
+            return window_.minsum();
+        }
+
+        template <typename Fun>
+        auto indexes(Fun pred) const
+        {
+            return window_.indexes(pred);
+        }
+
+        //
+        // the aggregate sketch and the sub-sketch of the current interval
+        //
+
+        sketch_type const &
+        window() const
+        {
+            return window_;
+        }
+
+        sketch_type const &
+        current() const
+        {
+            return slots_[current_];
+        }
+
+        void
+        reset()
+        {
+            tick_ = 0;
+            reset_();
+        }
+
+        constexpr inline std::pair<size_t, size_t>
+        size() const
+        {
+            return std::make_pair(sizeof...(Hs), W);
+        }
+
+    private:
+
+        void
+        reset_()
+        {
+            window_.reset();
+            for(auto & s : slots_)
+                s.reset();
+        }
+
+        sketch_type window_;
+        std::vector<sketch_type> slots_;
+        size_t current_ = 0;
+        uint64_t tick_ = 0;
+    };
+
+} // namespace pds
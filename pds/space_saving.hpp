@@ -0,0 +1,420 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cstdint>
+#include <cstddef>
+
+namespace pds {
+
+    //
+    // Space-Saving summary:
+    //
+    // Metwally, Agrawal, El Abbadi (2005). "Efficient Computation of Frequent
+    // and Top-k Elements in Data Streams". ICDT 2005.
+    //
+    // K counters kept in a stream-summary: counters with the same count are
+    // linked in a bucket, buckets are linked by increasing count. A unit update
+    // is O(1); when all counters are in use, the key with the minimum count is
+    // replaced and its count becomes the error of the newcomer. For every key:
+    //
+    //     count - error <= f(key) <= count,   error <= N/K
+    //
+    // Summaries are mergeable (Agarwal et al., "Mergeable Summaries", PODS 2012).
+    // Lists are index-based, on two pre-allocated arrays.
+    //
+
+    template <typename Key, size_t K, typename Hash = std::hash<Key>>
+    struct space_saving
+    {
+        static_assert(K > 0, "space_saving: K must be greater than 0!");
+
+        static constexpr int nil = -1;
+
+        struct entry
+        {
+            Key      key;
+            uint64_t count;
+            uint64_t error;
+        };
+
+        space_saving()
+        {
+            reset();
+        }
+
+        //
+        // update the summary with w occurrences of key
+        //
+
+        void update(Key const &key, uint64_t w = 1)
+        {
+            if (w == 0)
+                return;
+
+            total_ += w;
+
+            auto it = index_.find(key);
+            if (it != std::end(index_)) {
+                move_(it->second, counters_[it->second].count + w);
+                return;
+            }
+
+            int i;
+
+            if (size_ < K) {
+                i = static_cast<int>(size_++);
+                counters_[i].key   = key;
+                counters_[i].count = 0;
+                counters_[i].error = 0;
+                place_(i, nil, w);
+            }
+            else {
+                i = buckets_[first_].head;
+                index_.erase(counters_[i].key);
+                counters_[i].key   = key;
+                counters_[i].error = counters_[i].count;
+                move_(i, counters_[i].count + w);
+            }
+
+            index_.emplace(key, i);
+        }
+
+        void operator()(Key const &key)
+        {
+            update(key, 1);
+        }
+
+        //
+        // estimated count of a key (an upper bound of its frequency);
+        // for untracked keys the upper bound is min_count().
+        //
+
+        uint64_t count(Key const &key) const
+        {
+            auto it = index_.find(key);
+            return it != std::end(index_) ? counters_[it->second].count : 0;
+        }
+
+        uint64_t error(Key const &key) const
+        {
+            auto it = index_.find(key);
+            return it != std::end(index_) ? counters_[it->second].error : 0;
+        }
+
+        //
+        // lower bound of the frequency of a key
+        //
+
+        uint64_t guaranteed(Key const &key) const
+        {
+            return count(key) - error(key);
+        }
+
+        bool contains(Key const &key) const
+        {
+            return index_.count(key) != 0;
+        }
+
+        uint64_t min_count() const
+        {
+            return size_ < K ? 0 : buckets_[first_].count;
+        }
+
+        //
+        // the k keys with the highest count, by decreasing count: O(k)
+        //
+
+        std::vector<entry> top(size_t k = K) const
+        {
+            std::vector<entry> ret;
+            ret.reserve(std::min(k, size_));
+
+            for(int b = last_; b != nil && ret.size() < k; b = buckets_[b].prev)
+                for(int i = buckets_[b].head; i != nil && ret.size() < k; i = counters_[i].next)
+                    ret.push_back(entry{counters_[i].key, counters_[i].count, counters_[i].error});
+
+            return ret;
+        }
+
+        //
+        // the keys whose frequency may exceed phi * N; the ones whose
+        // guaranteed count exceeds it are frequent for sure.
+        //
+
+        std::vector<entry> frequent(double phi) const
+        {
+            std::vector<entry> ret;
+            auto thr = phi * total_;
+
+            for(int b = last_; b != nil && buckets_[b].count > thr; b = buckets_[b].prev)
+                for(int i = buckets_[b].head; i != nil; i = counters_[i].next)
+                    ret.push_back(entry{counters_[i].key, counters_[i].count, counters_[i].error});
+
+            return ret;
+        }
+
+        uint64_t total() const
+        {
+            return total_;
+        }
+
+        size_t size() const
+        {
+            return size_;
+        }
+
+        void reset()
+        {
+            index_.clear();
+            index_.reserve(K);
+
+            size_  = 0;
+            total_ = 0;
+            first_ = last_ = nil;
+
+            for(size_t n = 0; n < K; ++n)
+                buckets_[n].next = static_cast<int>(n) + 1 < static_cast<int>(K) ? static_cast<int>(n) + 1 : nil;
+
+            free_ = 0;
+        }
+
+        //
+        // merge: counts of common keys are added; a key missing in one
+        // summary gets that summary's minimum as count and error.
+        //
+
+        space_saving &
+        operator+=(space_saving const &other)
+        {
+            auto m1 = min_count(), m2 = other.min_count();
+
+            std::vector<entry> all;
+            all.reserve(size_ + other.size_);
+
+            for(size_t i = 0; i < size_; ++i)
+            {
+                auto e = entry{counters_[i].key, counters_[i].count, counters_[i].error};
+                auto it = other.index_.find(e.key);
+                if (it != std::end(other.index_)) {
+                    e.count += other.counters_[it->second].count;
+                    e.error += other.counters_[it->second].error;
+                }
+                else {
+                    e.count += m2;
+                    e.error += m2;
+                }
+                all.push_back(e);
+            }
+
+            for(size_t i = 0; i < other.size_; ++i)
+            {
+                auto const &c = other.counters_[i];
+                if (!contains(c.key))
+                    all.push_back(entry{c.key, c.count + m1, c.error + m1});
+            }
+
+            auto n = std::min(all.size(), K);
+            std::partial_sort(std::begin(all), std::begin(all) + n, std::end(all), [](entry const &a, entry const &b) {
+                return a.count > b.count;
+            });
+
+            auto total = total_ + other.total_;
+
+            reset();
+
+            for(size_t j = n; j > 0; --j)
+            {
+                auto i = static_cast<int>(size_++);
+                counters_[i].key   = all[j-1].key;
+                counters_[i].count = 0;
+                counters_[i].error = all[j-1].error;
+                place_(i, last_, all[j-1].count);
+                index_.emplace(all[j-1].key, i);
+            }
+
+            total_ = total;
+            return *this;
+        }
+
+    private:
+
+        struct counter
+        {
+            Key      key;
+            uint64_t count;
+            uint64_t error;
+            int      bucket;
+            int      prev;
+            int      next;
+        };
+
+        struct bucket
+        {
+            uint64_t count;
+            int      head;
+            int      prev;
+            int      next;
+        };
+
+        //
+        // move the counter i to the bucket of the given (greater) count
+        //
+
+        void move_(int i, uint64_t count)
+        {
+            auto b = counters_[i].bucket;
+
+            unlink_(i);
+
+            if (buckets_[b].head == nil) {
+                auto from = buckets_[b].prev;
+                free_bucket_(b);
+                place_(i, from, count);
+            }
+            else
+                place_(i, b, count);
+        }
+
+        //
+        // link the counter i to the bucket of the given count, searching
+        // it forward from the bucket 'from' (nil: the first one)
+        //
+
+        void place_(int i, int from, uint64_t count)
+        {
+            int prev = from, cur = from == nil ? first_ : buckets_[from].next;
+
+            if (from != nil && buckets_[from].count == count) {
+                link_(i, from);
+                return;
+            }
+
+            while (cur != nil && buckets_[cur].count < count) {
+                prev = cur;
+                cur  = buckets_[cur].next;
+            }
+
+            if (cur != nil && buckets_[cur].count == count) {
+                link_(i, cur);
+                return;
+            }
+
+            auto b = free_;
+            free_  = buckets_[b].next;
+
+            buckets_[b].count = count;
+            buckets_[b].head  = nil;
+            buckets_[b].prev  = prev;
+            buckets_[b].next  = cur;
+
+            if (prev != nil)
+                buckets_[prev].next = b;
+            else
+                first_ = b;
+
+            if (cur != nil)
+                buckets_[cur].prev = b;
+            else
+                last_ = b;
+
+            link_(i, b);
+        }
+
+        void link_(int i, int b)
+        {
+            auto &c = counters_[i];
+
+            c.count  = buckets_[b].count;
+            c.bucket = b;
+            c.prev   = nil;
+            c.next   = buckets_[b].head;
+
+            if (c.next != nil)
+                counters_[c.next].prev = i;
+
+            buckets_[b].head = i;
+        }
+
+        void unlink_(int i)
+        {
+            auto &c = counters_[i];
+
+            if (c.prev != nil)
+                counters_[c.prev].next = c.next;
+            else
+                buckets_[c.bucket].head = c.next;
+
+            if (c.next != nil)
+                counters_[c.next].prev = c.prev;
+        }
+
+        void free_bucket_(int b)
+        {
+            auto &bk = buckets_[b];
+
+            if (bk.prev != nil)
+                buckets_[bk.prev].next = bk.next;
+            else
+                first_ = bk.next;
+
+            if (bk.next != nil)
+                buckets_[bk.next].prev = bk.prev;
+            else
+                last_ = bk.prev;
+
+            bk.next = free_;
+            free_   = b;
+        }
+
+        std::vector<counter> counters_ = std::vector<counter>(K);
+        std::vector<bucket>  buckets_  = std::vector<bucket>(K);
+
+        std::unordered_map<Key, int, Hash> index_;
+
+        size_t   size_;
+        uint64_t total_;
+        int      first_;
+        int      last_;
+        int      free_;
+    };
+
+
+    template <typename Key, size_t K, typename Hash>
+    space_saving<Key, K, Hash>
+    operator+(space_saving<Key, K, Hash> lhs, space_saving<Key, K, Hash> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
@@ -0,0 +1,274 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+#include <pds/hash.hpp>
+
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // SpreadSketch: per-key cardinality and superspreader detection:
+    //
+    // Tang, Huang, Lee (2020). "SpreadSketch: Toward Invertible and
+    // Network-Wide Detection of Superspreaders".
+    // Estan, Varghese, Fisk (2006). "Bitmap Algorithms for Counting Active
+    // Flows on High-Speed Links" (multiresolution bitmap).
+    //
+    // D rows of W buckets; a key is hashed to one bucket per row, each one
+    // holding a multiresolution bitmap of C 64-bit components for the
+    // distinct elements of the keys sharing it, plus a candidate key label:
+    // every (key, elem) draws a geometric level, and the key with the highest
+    // level seen replaces the label, so that the keys with many distinct
+    // elements are the likely survivors. Superspreaders are read from the
+    // labels directly, without reversing the hashes.
+    //
+    // The spread of a key is the minimum over its D bitmaps; with 64-bit
+    // components a bitmap has a relative standard error of about 12%, and
+    // C components count up to ~2^C * 64 elements.
+    //
+
+    template <typename Key, size_t D, size_t W, size_t C = 10, typename Hash = std::hash<Key>>
+    struct spread_sketch
+    {
+        static_assert(D > 0 && W > 0, "spread_sketch: empty sketch!");
+        static_assert(C >= 2 && C <= 32, "spread_sketch: components must be in [2,32]!");
+
+        struct bucket
+        {
+            std::array<uint64_t, C> bitmap;
+            Key key;
+            uint8_t level;      // 0 means no label, the level is (level - 1)
+        };
+
+        template <typename X = Hash>
+        spread_sketch(X x = X())
+        : buckets_(D * W, bucket{ {}, Key{}, 0 })
+        , hash_(x)
+        { }
+
+        //
+        // process the element elem of key:
+        //
+
+        template <typename T>
+        void update(Key const &key, T const &elem)
+        {
+            auto hk = hash_(key);
+            auto h  = hash64(elem, Mix64{}(hk));
+
+            auto comp  = std::min<size_t>(h ? __builtin_ctzll(h) : 64, C - 1);
+            auto bit   = h >> 58;
+            auto g     = Mix64{}(h + 0x9e3779b97f4a7c15ULL);
+            auto level = static_cast<uint8_t>((g ? __builtin_clzll(g) : 64) + 1);
+
+            for(size_t r = 0; r < D; ++r)
+            {
+                auto &b = buckets_[r * W + index_(hk, r)];
+
+                b.bitmap[comp] |= 1ULL << bit;
+                if (level >= b.level) {
+                    b.key   = key;
+                    b.level = level;
+                }
+            }
+        }
+
+        template <typename T>
+        void operator()(Key const &key, T const &elem)
+        {
+            update(key, elem);
+        }
+
+        //
+        // estimated number of distinct elements of key
+        //
+
+        double spread(Key const &key) const
+        {
+            auto hk = hash_(key);
+            auto ret = std::numeric_limits<double>::infinity();
+
+            for(size_t r = 0; r < D; ++r)
+                ret = std::min(ret, estimate(buckets_[r * W + index_(hk, r)]));
+
+            return ret;
+        }
+
+        //
+        // keys with a spread of at least threshold, in decreasing order of spread
+        //
+
+        std::vector<std::pair<Key, double>>
+        superspreaders(double threshold) const
+        {
+            std::vector<Key> cand;
+
+            for(auto const &b : buckets_)
+                if (b.level && estimate(b) >= threshold)
+                    cand.push_back(b.key);
+
+            std::sort(std::begin(cand), std::end(cand));
+            cand.erase(std::unique(std::begin(cand), std::end(cand)), std::end(cand));
+
+            std::vector<std::pair<Key, double>> ret;
+
+            for(auto const &k : cand)
+            {
+                auto s = spread(k);
+                if (s >= threshold)
+                    ret.emplace_back(k, s);
+            }
+
+            std::sort(std::begin(ret), std::end(ret), [](auto const &a, auto const &b) {
+                return a.second > b.second;
+            });
+
+            return ret;
+        }
+
+        //
+        // estimated number of distinct (key, elem) pairs: every pair is in
+        // exactly one bucket per row
+        //
+
+        double total() const
+        {
+            auto ret = std::numeric_limits<double>::infinity();
+
+            for(size_t r = 0; r < D; ++r)
+            {
+                double sum = 0;
+                for(size_t i = 0; i < W; ++i)
+                    sum += estimate(buckets_[r * W + i]);
+                ret = std::min(ret, sum);
+            }
+
+            return ret;
+        }
+
+        //
+        // multiresolution bitmap estimate: component j < C-1 samples 2^-(j+1)
+        // of the elements, the last one 2^-(C-1); linear counting is summed
+        // from the first component that is not saturated
+        //
+
+        static double estimate(bucket const &b)
+        {
+            constexpr int setmax = 44;      // ~70% of the bits
+
+            size_t base = 0;
+            while (base < C - 1 && __builtin_popcountll(b.bitmap[base]) > setmax)
+                base++;
+
+            double n = 0;
+            for(size_t j = base; j < C; ++j)
+            {
+                auto zeros = 64 - __builtin_popcountll(b.bitmap[j]);
+                n += 64 * std::log(64.0 / std::max(zeros, 1));
+            }
+
+            return std::ldexp(n, static_cast<int>(base));
+        }
+
+        bucket const &
+        at(size_t row, size_t i) const
+        {
+            return buckets_[row * W + i];
+        }
+
+        void reset()
+        {
+            std::fill(std::begin(buckets_), std::end(buckets_), bucket{ {}, Key{}, 0 });
+        }
+
+        //
+        // merge another sketch: bitmaps are or-ed, the higher level keeps its label
+        //
+
+        spread_sketch &
+        operator+=(spread_sketch const &other)
+        {
+            for(size_t i = 0; i < D * W; ++i)
+            {
+                auto &b = buckets_[i];
+                auto const &o = other.buckets_[i];
+
+                for(size_t j = 0; j < C; ++j)
+                    b.bitmap[j] |= o.bitmap[j];
+
+                if (o.level > b.level) {
+                    b.key   = o.key;
+                    b.level = o.level;
+                }
+            }
+
+            return *this;
+        }
+
+        constexpr std::pair<size_t, size_t>
+        size() const
+        {
+            return std::make_pair(D, W);
+        }
+
+        constexpr size_t
+        memory() const
+        {
+            return D * W * sizeof(bucket);
+        }
+
+    private:
+
+        static size_t index_(uint64_t hk, size_t row)
+        {
+            return Mix64{}(hk + (row + 1) * 0x9e3779b97f4a7c15ULL) % W;
+        }
+
+        std::vector<bucket> buckets_;
+        Hash hash_;
+    };
+
+
+    template <typename Key, size_t D, size_t W, size_t C, typename Hash>
+    inline spread_sketch<Key, D, W, C, Hash>
+    operator+(spread_sketch<Key, D, W, C, Hash> lhs, spread_sketch<Key, D, W, C, Hash> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+} // namespace pds
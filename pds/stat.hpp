@@ -1,5 +1,10 @@
 #pragma once
 
+#include <pds/hash.hpp>
+
+#include <array>
+#include <algorithm>
+#include <functional>
 #include <cstdint>
 #include <cstddef>
 #include <cmath>
@@ -92,5 +97,82 @@ namespace pds { namespace stat
         double acc = 0;
     };
 
+    // Streaming (Shannon) entropy, in nats...
+    //
+    // Clifford, Cosma (2013). "A simple sketching algorithm for entropy estimation
+    // over streaming data".
+    //
+    // every element draws, from its hash, K maximally skewed 1-stable variates
+    // r_j ~ S(1,-1,1,0) (Chambers-Mallows-Stuck); the sketch keeps
+    // y_j = sum_i f_i r_j(i) and the stream length m. Then y_j/m is distributed
+    // as r - 2/pi H, and since E[exp(pi/2 r)] = pi/2:
+    //
+    //      H = -log(2/pi * 1/K sum_j exp(pi/2 y_j / m))
+    //
+    // The update costs K variates, with no allocation; the error decreases as
+    // 1/sqrt(K). Sketches merge by summing y and m.
+    //
+    template <size_t K = 64, typename Hash = std::hash<uint64_t>>
+    struct entropy
+    {
+        template <typename T>
+        void operator()(T const &elem, uint64_t count = 1)
+        {
+            auto h = Mix64{}(hash(elem));
+
+            for(size_t j = 0; j < K; ++j)
+            {
+                auto r = Mix64{}(h + (j + 1) * 0x9e3779b97f4a7c15ULL);
+                y[j] += static_cast<double>(count) * variate(r);
+            }
+
+            m += count;
+        }
+
+        double value() const
+        {
+            if (m == 0)
+                return 0;
+
+            double acc = 0;
+            for(size_t j = 0; j < K; ++j)
+                acc += std::exp(M_PI / 2 * y[j] / m);
+
+            return std::max(0.0, -std::log(2 / M_PI * acc / K));
+        }
+
+        void reset()
+        {
+            y.fill(0);
+            m = 0;
+        }
+
+        entropy &
+        operator+=(entropy const &other)
+        {
+            for(size_t j = 0; j < K; ++j)
+                y[j] += other.y[j];
+            m += other.m;
+            return *this;
+        }
+
+        // S(1,-1,1,0) variate from the two 32-bit halves of a hash...
+        //
+        static double variate(uint64_t r)
+        {
+            auto u1 = ((r >> 32) + 0.5) / 4294967296.0;
+            auto u2 = ((r & 0xffffffff) + 0.5) / 4294967296.0;
+
+            auto v = M_PI * (u1 - 0.5);
+            auto w = -std::log(u2);
+
+            return 2 / M_PI * ((M_PI / 2 - v) * std::tan(v) + std::log((M_PI / 2) * w * std::cos(v) / (M_PI / 2 - v)));
+        }
+
+        std::array<double, K> y = {};
+        uint64_t m = 0;
+        Hash hash;
+    };
+
 } // namespace stat
 } // namespace pds
@@ -0,0 +1,318 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <array>
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Merging t-digest:
+    //
+    // Dunning, Ertl (2019). "Computing Extremely Accurate Quantiles Using t-Digests".
+    //
+    // inserts are buffered in a fixed array; when it is full, the buffer and
+    // the centroids are sorted and merged in one pass, under the k2 scale
+    // function k(q) = delta / Z(n) * log(q / (1 - q)), Z(n) = 4 log(n/delta) + 24,
+    // whose centroids shrink as q(1-q) near the tails (p99.9 and beyond).
+    // Centroids are stored as structure of arrays (means, weights and
+    // cumulative weights) with no dynamic allocation, so that the digest
+    // can be a cell of a pds::sketch; eval() is the count.
+    // Queries merge the pending buffer first (the summary does not change),
+    // hence they are not safe against concurrent readers.
+    //
+
+    template <size_t Compression = 100, size_t Buffer = 128>
+    struct tdigest
+    {
+        static_assert(Compression >= 10, "tdigest: compression must be at least 10!");
+        static_assert(Buffer > 0,        "tdigest: buffer must not be empty!");
+
+        static constexpr size_t capacity = 2 * Compression;
+
+        //
+        // add a value (with weight)
+        //
+
+        void update(double value, double weight = 1.0)
+        {
+            if (nbuf_ == Buffer)
+                flush();
+
+            buffer_[nbuf_]   = value;
+            bweight_[nbuf_]  = weight;
+            nbuf_++;
+
+            count_ += weight;
+            min_ = std::min(min_, value);
+            max_ = std::max(max_, value);
+        }
+
+        void operator()(double value)
+        {
+            update(value);
+        }
+
+        //
+        // merge the buffered values into the centroids
+        //
+
+        void flush() const
+        {
+            if (nbuf_ == 0)
+                return;
+
+            std::array<std::pair<double, double>, capacity + Buffer> in;
+            size_t n = 0;
+
+            for(size_t i = 0; i < ncent_; ++i)
+                in[n++] = std::make_pair(mean_[i], weight_[i]);
+            for(size_t i = 0; i < nbuf_; ++i)
+                in[n++] = std::make_pair(buffer_[i], bweight_[i]);
+
+            nbuf_ = 0;
+            compress_(in.data(), n);
+        }
+
+        //
+        // the value at quantile q (q in [0,1])
+        //
+
+        double quantile(double q) const
+        {
+            if (count_ == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            flush();
+            auto const &d = *this;
+
+            if (q <= 0)
+                return d.min_;
+            if (q >= 1)
+                return d.max_;
+
+            auto target = q * d.count_;
+
+            // index of the first centroid whose center is above the target:
+            // a branch-free count over the cumulative weights
+
+            size_t i = 0;
+            for(size_t j = 0; j < d.ncent_; ++j)
+                i += (d.cum_[j] - d.weight_[j] / 2) <= target;
+
+            if (i == 0)
+                return interpolate_(0, d.weight_[0] / 2, target, d.min_, d.mean_[0]);
+
+            if (i == d.ncent_) {
+                auto c = d.cum_[i-1] - d.weight_[i-1] / 2;
+                return interpolate_(c, d.count_, target, d.mean_[i-1], d.max_);
+            }
+
+            auto c0 = d.cum_[i-1] - d.weight_[i-1] / 2;
+            auto c1 = d.cum_[i]   - d.weight_[i] / 2;
+
+            return interpolate_(c0, c1, target, d.mean_[i-1], d.mean_[i]);
+        }
+
+        //
+        // the fraction of values less than or equal to x
+        //
+
+        double cdf(double x) const
+        {
+            if (count_ == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+
+            flush();
+            auto const &d = *this;
+
+            if (x < d.min_)
+                return 0;
+            if (x >= d.max_)
+                return 1;
+
+            size_t i = 0;
+            for(size_t j = 0; j < d.ncent_; ++j)
+                i += d.mean_[j] <= x;
+
+            double rank;
+
+            if (i == 0)
+                rank = interpolate_(d.min_, d.mean_[0], x, 0, d.weight_[0] / 2);
+            else if (i == d.ncent_)
+                rank = interpolate_(d.mean_[i-1], d.max_, x, d.cum_[i-1] - d.weight_[i-1] / 2, d.count_);
+            else
+                rank = interpolate_(d.mean_[i-1], d.mean_[i], x, d.cum_[i-1] - d.weight_[i-1] / 2, d.cum_[i] - d.weight_[i] / 2);
+
+            return rank / d.count_;
+        }
+
+        double count() const
+        {
+            return count_;
+        }
+
+        double eval() const
+        {
+            return count_;
+        }
+
+        double min() const { return min_; }
+        double max() const { return max_; }
+
+        size_t centroids() const
+        {
+            flush();
+            return ncent_;
+        }
+
+        void reset()
+        {
+            *this = tdigest{};
+        }
+
+        //
+        // merge another digest
+        //
+
+        tdigest &
+        operator+=(tdigest const &other)
+        {
+            if (other.count_ == 0)
+                return *this;
+
+            std::array<std::pair<double, double>, 2 * (capacity + Buffer)> in;
+            size_t n = 0;
+
+            for(tdigest const *d : { static_cast<tdigest const *>(this), &other })
+            {
+                for(size_t i = 0; i < d->ncent_; ++i)
+                    in[n++] = std::make_pair(d->mean_[i], d->weight_[i]);
+                for(size_t i = 0; i < d->nbuf_; ++i)
+                    in[n++] = std::make_pair(d->buffer_[i], d->bweight_[i]);
+            }
+
+            count_ += other.count_;
+            min_ = std::min(min_, other.min_);
+            max_ = std::max(max_, other.max_);
+            nbuf_ = 0;
+
+            compress_(in.data(), n);
+            return *this;
+        }
+
+    private:
+
+        static double k2_(double q, double norm)
+        {
+            return norm * std::log(q / (1 - q));
+        }
+
+        static double interpolate_(double x0, double x1, double x, double y0, double y1)
+        {
+            if (x1 <= x0)
+                return (y0 + y1) / 2;
+            return y0 + (x - x0) / (x1 - x0) * (y1 - y0);
+        }
+
+        void compress_(std::pair<double, double> *in, size_t n) const
+        {
+            std::sort(in, in + n, [](std::pair<double, double> const &a, std::pair<double, double> const &b) {
+                return a.first < b.first;
+            });
+
+            double total = 0;
+            for(size_t i = 0; i < n; ++i)
+                total += in[i].second;
+
+            ncent_ = 0;
+            if (n == 0)
+                return;
+
+            double done = 0;                    // weight of the emitted centroids
+            double m = in[0].first, w = in[0].second;
+            double norm = Compression / (4 * std::log(std::max(total / Compression, 1.0)) + 24);
+            double k_lo = k2_(0, norm);
+
+            for(size_t i = 1; i < n; ++i)
+            {
+                auto q = (done + w + in[i].second) / total;
+
+                if (k2_(q, norm) - k_lo <= 1.0 || ncent_ >= capacity - 1) {
+                    w += in[i].second;
+                    m += (in[i].first - m) * in[i].second / w;
+                }
+                else {
+                    emit_(m, w, done);
+                    k_lo = k2_(done / total, norm);
+                    m = in[i].first;
+                    w = in[i].second;
+                }
+            }
+
+            emit_(m, w, done);
+        }
+
+        void emit_(double m, double w, double &done) const
+        {
+            done += w;
+            mean_[ncent_]   = m;
+            weight_[ncent_] = w;
+            cum_[ncent_]    = done;
+            ncent_++;
+        }
+
+        mutable std::array<double, capacity> mean_;
+        mutable std::array<double, capacity> weight_;
+        mutable std::array<double, capacity> cum_;
+        mutable size_t ncent_ = 0;
+
+        std::array<double, Buffer> buffer_;
+        std::array<double, Buffer> bweight_;
+        mutable size_t nbuf_ = 0;
+
+        double count_ = 0;
+        double min_ = std::numeric_limits<double>::infinity();
+        double max_ = -std::numeric_limits<double>::infinity();
+    };
+
+
+    template <size_t Compression, size_t Buffer>
+    tdigest<Compression, Buffer>
+    operator+(tdigest<Compression, Buffer> lhs, tdigest<Compression, Buffer> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
@@ -0,0 +1,286 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/utility.hpp>
+#include <pds/hash.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace pds {
+
+    //
+    // Theta sketch (k minimum values):
+    //
+    // Bar-Yossef et al. (2002). "Counting Distinct Elements in a Data Stream".
+    // Dasgupta, Lang, Rhodes, Thaler (2016). "A Framework for Estimating Stream
+    // Expression Cardinalities".
+    //
+    // the sketch keeps the 64-bit hashes below a threshold theta in an
+    // open-addressing table of 2K slots; when the table is 3/4 full it is
+    // rebuilt lazily: the K-th smallest hash (nth_element) becomes the new
+    // theta and the larger ones are dropped. The number of distinct elements
+    // is estimated as retained / (theta / 2^64), with a relative standard
+    // error of about 1/sqrt(K).
+    //
+    // Union (operator+=), intersection and a-not-b take the smallest theta of
+    // the operands and combine the retained hashes below it, so that their
+    // error stays bounded the same way.
+    //
+
+    template <size_t K, typename Hash = std::hash<uint64_t>>
+    struct theta_sketch
+    {
+        static_assert(K >= 16 && (K & (K-1)) == 0, "theta_sketch: K must be a power of two (at least 16)!");
+
+        static constexpr size_t capacity = 2 * K;
+        static constexpr uint64_t max_theta = std::numeric_limits<uint64_t>::max();
+
+        template <typename X = Hash>
+        theta_sketch(X x = X())
+        : table_(capacity)
+        , hash_(x)
+        { }
+
+        //
+        // hash and process the element:
+        //
+
+        template <typename T>
+        void update(T const &elem)
+        {
+            insert_(Mix64{}(hash_(elem)));
+        }
+
+        template <typename T>
+        void operator()(T const &elem)
+        {
+            update(elem);
+        }
+
+        //
+        // estimated number of distinct elements
+        //
+
+        double estimate() const
+        {
+            if (theta_ == max_theta)
+                return static_cast<double>(n_);
+
+            return n_ / theta();
+        }
+
+        double eval() const
+        {
+            return estimate();
+        }
+
+        //
+        // approximate bounds, z standard deviations from the estimate
+        //
+
+        double lower_bound(double z = 2.0) const
+        {
+            return std::max<double>(n_, estimate() * (1 - z * rse_()));
+        }
+
+        double upper_bound(double z = 2.0) const
+        {
+            return estimate() * (1 + z * rse_());
+        }
+
+        //
+        // sampling threshold as a fraction of the hash space
+        //
+
+        double theta() const
+        {
+            return std::ldexp(static_cast<double>(theta_), -64);
+        }
+
+        bool is_exact() const
+        {
+            return theta_ == max_theta;
+        }
+
+        size_t retained() const
+        {
+            return n_;
+        }
+
+        //
+        // the retained hashes, in no particular order
+        //
+
+        template <typename Fun>
+        void foreach_hash(Fun fun) const
+        {
+            for(auto h : table_)
+                if (h)
+                    fun(h);
+        }
+
+        bool contains_hash(uint64_t h) const
+        {
+            for(size_t i = h & (capacity - 1); table_[i]; i = (i + 1) & (capacity - 1))
+                if (table_[i] == h)
+                    return true;
+            return false;
+        }
+
+        void reset()
+        {
+            std::fill(std::begin(table_), std::end(table_), 0);
+            theta_ = max_theta;
+            n_ = 0;
+        }
+
+        //
+        // union with another sketch
+        //
+
+        theta_sketch &
+        operator+=(theta_sketch const &other)
+        {
+            if (other.theta_ < theta_)
+                rebuild_(other.theta_);
+
+            other.foreach_hash([&](uint64_t h) { insert_(h); });
+            return *this;
+        }
+
+        //
+        // set algebra: the result keeps the smallest theta and the hashes of
+        // a that are (not) retained by b
+        //
+
+        friend theta_sketch
+        intersection(theta_sketch const &a, theta_sketch const &b)
+        {
+            return a.filter_(b, true);
+        }
+
+        friend theta_sketch
+        a_not_b(theta_sketch const &a, theta_sketch const &b)
+        {
+            return a.filter_(b, false);
+        }
+
+    private:
+
+        double rse_() const
+        {
+            return is_exact() ? 0.0 : std::sqrt((1 - theta()) / std::max<size_t>(n_, 1));
+        }
+
+        theta_sketch filter_(theta_sketch const &b, bool keep) const
+        {
+            theta_sketch ret(hash_);
+            ret.theta_ = std::min(theta_, b.theta_);
+
+            foreach_hash([&](uint64_t h) {
+                if (h < ret.theta_ && b.contains_hash(h) == keep)
+                    ret.put_(h);
+            });
+
+            return ret;
+        }
+
+        void insert_(uint64_t h)
+        {
+            if (h == 0 || h >= theta_)
+                return;
+
+            if (put_(h) && n_ >= capacity * 3 / 4)
+                rebuild_(max_theta);
+        }
+
+        //
+        // add h to the table, unless already present
+        //
+
+        bool put_(uint64_t h)
+        {
+            auto i = h & (capacity - 1);
+            for(; table_[i]; i = (i + 1) & (capacity - 1))
+                if (table_[i] == h)
+                    return false;
+
+            table_[i] = h;
+            n_++;
+            return true;
+        }
+
+        //
+        // drop the hashes above the new theta (at most K retained)
+        //
+
+        void rebuild_(uint64_t theta)
+        {
+            std::vector<uint64_t> v;
+            v.reserve(n_);
+
+            for(auto h : table_)
+                if (h && h < theta)
+                    v.push_back(h);
+
+            if (v.size() > K) {
+                std::nth_element(std::begin(v), std::begin(v) + K, std::end(v));
+                theta = v[K];
+                v.resize(K);
+            }
+
+            theta_ = std::min(theta_, theta);
+
+            std::fill(std::begin(table_), std::end(table_), 0);
+            n_ = 0;
+
+            for(auto h : v)
+                put_(h);
+        }
+
+        std::vector<uint64_t> table_;
+        uint64_t theta_ = max_theta;
+        size_t n_ = 0;
+        Hash hash_;
+    };
+
+
+    template <size_t K, typename Hash>
+    inline theta_sketch<K, Hash>
+    operator+(theta_sketch<K, Hash> lhs, theta_sketch<K, Hash> const &rhs)
+    {
+        return lhs += rhs;
+    }
+
+} // namespace pds
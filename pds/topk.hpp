@@ -0,0 +1,318 @@
+/******************************************************************************
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014-15 Nicola Bonelli <nicola@pfq.io>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <pds/sketch.hpp>
+
+#include <vector>
+#include <map>
+#include <limits>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cstddef>
+
+namespace pds {
+
+    //
+    // Top-k tracker:
+    //
+    // a min-heap of (at most) K keys with their estimated count, indexed by
+    // key. update() is O(log K), the current heavy hitters are available in
+    // O(K) at any time.
+    //
+
+    template <typename Key, size_t K, typename T = uint64_t, typename Compare = std::less<Key>>
+    struct topk
+    {
+        static_assert(K > 0, "topk: K must be greater than 0!");
+
+        struct entry
+        {
+            Key key;
+            T   count;
+        };
+
+        //
+        // update the estimate of a key: the key enters the heap if it is
+        // already tracked, the heap is not full or it beats the minimum.
+        //
+
+        void update(Key const &key, T count)
+        {
+            auto it = pos_.find(key);
+            if (it != std::end(pos_))
+            {
+                auto i = it->second;
+                auto old = heap_[i].count;
+                heap_[i].count = count;
+                if (count < old)
+                    sift_up_(i);
+                else
+                    sift_down_(i);
+                return;
+            }
+
+            if (heap_.size() < K)
+            {
+                heap_.push_back(entry{key, count});
+                pos_.emplace(key, heap_.size() - 1);
+                sift_up_(heap_.size() - 1);
+                return;
+            }
+
+            if (count > heap_.front().count)
+            {
+                pos_.erase(heap_.front().key);
+                heap_.front() = entry{key, count};
+                pos_.emplace(key, 0);
+                sift_down_(0);
+            }
+        }
+
+        //
+        // minimum count to enter the heap
+        //
+
+        T threshold() const
+        {
+            return heap_.size() < K ? T{} : heap_.front().count;
+        }
+
+        bool contains(Key const &key) const
+        {
+            return pos_.count(key) != 0;
+        }
+
+        //
+        // the tracked keys (heap order)
+        //
+
+        std::vector<entry> const &
+        entries() const
+        {
+            return heap_;
+        }
+
+        //
+        // the tracked keys, by decreasing count
+        //
+
+        std::vector<entry>
+        top() const
+        {
+            auto ret = heap_;
+            std::sort(std::begin(ret), std::end(ret), [](entry const &a, entry const &b) {
+                return a.count > b.count;
+            });
+            return ret;
+        }
+
+        size_t size() const
+        {
+            return heap_.size();
+        }
+
+        void reset()
+        {
+            heap_.clear();
+            pos_.clear();
+        }
+
+    private:
+
+        void swap_(size_t i, size_t j)
+        {
+            std::swap(heap_[i], heap_[j]);
+            pos_[heap_[i].key] = i;
+            pos_[heap_[j].key] = j;
+        }
+
+        void sift_up_(size_t i)
+        {
+            while (i > 0)
+            {
+                auto p = (i - 1) / 2;
+                if (!(heap_[i].count < heap_[p].count))
+                    break;
+                swap_(i, p);
+                i = p;
+            }
+        }
+
+        void sift_down_(size_t i)
+        {
+            for(;;)
+            {
+                auto l = 2 * i + 1, r = l + 1, m = i;
+
+                if (l < heap_.size() && heap_[l].count < heap_[m].count)
+                    m = l;
+                if (r < heap_.size() && heap_[r].count < heap_[m].count)
+                    m = r;
+                if (m == i)
+                    break;
+                swap_(i, m);
+                i = m;
+            }
+        }
+
+        std::vector<entry> heap_;
+        std::map<Key, size_t, Compare> pos_;
+    };
+
+    //
+    // Sketch with heavy-hitter tracking:
+    //
+    // a count-min sketch that keeps the K keys with the highest estimate.
+    // increment_buckets() computes the estimate of the key while updating
+    // its buckets and feeds the top-k heap, so that the heavy hitters of the
+    // current interval are known in real time, without reversing the sketch.
+    //
+    // The sketch is inherited privately: only the read-only queries are
+    // exported, as updates that bypass increment_buckets() would leave the
+    // top-k out of sync with the counters.
+    //
+
+    template <typename Key, size_t K, typename T, std::size_t W, typename ...Hs>
+    struct topk_sketch : private sketch<T, W, Hs...>
+    {
+        using base_type = sketch<T, W, Hs...>;
+        using entry     = typename topk<Key, K, T>::entry;
+
+        using base_type::bucket_indexes;
+        using base_type::buckets;
+        using base_type::count;
+        using base_type::estimate;
+        using base_type::row_sums;
+        using base_type::minsum;
+        using base_type::indexes;
+        using base_type::filter;
+        using base_type::size;
+
+        template <typename ...Xs>
+        topk_sketch(Xs ... xs)
+        : base_type(xs...)
+        { }
+
+        //
+        // increment/decrement buckets and update the top-k
+        //
+
+        void increment_buckets(Key const &elem, T value = 1)
+        {
+            T n = std::numeric_limits<T>::max();
+
+            this->foreach_bucket(elem, [&](T &bucket) {
+                bucket += value;
+                n = std::min(n, bucket);
+            });
+
+            if (n > topk_.threshold() || topk_.contains(elem))
+                topk_.update(elem, n);
+        }
+
+        void decrement_buckets(Key const &elem, T value = 1)
+        {
+            T n = std::numeric_limits<T>::max();
+
+            this->foreach_bucket(elem, [&](T &bucket) {
+                bucket -= value;
+                n = std::min(n, bucket);
+            });
+
+            if (topk_.contains(elem))
+                topk_.update(elem, n);
+        }
+
+        //
+        // the heavy hitters, in heap order (O(K)) or by decreasing count
+        //
+
+        std::vector<entry> const &
+        heavy_hitters() const
+        {
+            return topk_.entries();
+        }
+
+        std::vector<entry>
+        top() const
+        {
+            return topk_.top();
+        }
+
+        //
+        // the underlying sketch (e.g. for reverse_sketch)
+        //
+
+        base_type const &
+        counters() const
+        {
+            return *this;
+        }
+
+        void reset()
+        {
+            base_type::reset();
+            topk_.reset();
+        }
+
+        //
+        // merge: the tracked keys of both sketches are estimated again
+        // on the merged counters
+        //
+
+        topk_sketch &
+        operator+=(topk_sketch const &other)
+        {
+            base_type::operator+=(other);
+
+            auto keys = topk_.entries();
+            keys.insert(std::end(keys), std::begin(other.topk_.entries()), std::end(other.topk_.entries()));
+
+            topk_.reset();
+            for(auto const &e : keys)
+                topk_.update(e.key, this->count(e.key));
+
+            return *this;
+        }
+
+    private:
+
+        topk<Key, K, T> topk_;
+    };
+
+
+    template <typename Key, size_t K, typename T, std::size_t W, typename ...Hs>
+    topk_sketch<Key, K, T, W, Hs...>
+    operator+(topk_sketch<Key, K, T, W, Hs...> lhs, topk_sketch<Key, K, T, W, Hs...> const &rhs)
+    {
+        lhs += rhs;
+        return lhs;
+    }
+
+} // namespace pds
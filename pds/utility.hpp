@@ -91,5 +91,41 @@ namespace pds {
         return (1ULL << bits)-1;
     }
 
+    //
+    // small and fast pseudo-random generator (Marsaglia's xorshift64*),
+    // for the randomized choices of the sampling structures.
+    //
+
+    struct xorshift64
+    {
+        using result_type = uint64_t;
+
+        explicit xorshift64(uint64_t seed = 0x2545f4914f6cdd1dULL)
+        : state(seed ? seed : 0x2545f4914f6cdd1dULL)
+        { }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return ~result_type{0}; }
+
+        result_type operator()()
+        {
+            state ^= state >> 12;
+            state ^= state << 25;
+            state ^= state >> 27;
+            return state * 0x2545f4914f6cdd1dULL;
+        }
+
+        //
+        // uniform double in [0,1)
+        //
+
+        double uniform()
+        {
+            return ((*this)() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+        uint64_t state;
+    };
+
 
 } // nemespace pds
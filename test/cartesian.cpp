@@ -85,6 +85,72 @@ auto g = Group("Cartesian")
 
     })
 
+    .Single("foreach_cartesian_product_by", []
+    {
+        std::vector<pds::annotated<int, Indices>> v1 = {
+                                             pds::annotate(150, Indices { std::vector<size_t>{2,5}, 
+                                                                                std::vector<size_t>{1}, }),
+                                             pds::annotate(47,  Indices { std::vector<size_t>{3}, 
+                                                                                std::vector<size_t>{5}, }),
+                                             pds::annotate(236, Indices { std::vector<size_t>{2}, 
+                                                                                std::vector<size_t>{2,3,7} })
+                                          };
+
+        std::vector<pds::annotated<int, Indices>> v2 = {
+                                             pds::annotate(72, Indices { std::vector<size_t>{1,2}, 
+                                                                               std::vector<size_t>{1,5}, }),
+                                             pds::annotate(104, Indices { std::vector<size_t>{1,2}, 
+                                                                                std::vector<size_t>{2,6}, }),
+                                          };
+
+        std::vector<pds::annotated<int, Indices>> v3 = {
+                                             pds::annotate(182, Indices{ std::vector<size_t>{1,2 }, 
+                                                                               std::vector<size_t>{1}, }),
+                                             pds::annotate(32,  Indices { std::vector<size_t>{2}, 
+                                                                                std::vector<size_t>{1}, }),
+                                             pds::annotate(49,  Indices { std::vector<size_t>{2}, 
+                                                                                std::vector<size_t>{2, 6}, }),
+                                          };
+
+        auto vs = std::make_tuple(v1, v2, v3);
+
+        auto ref = pds::expand_cartesian_product_by(vs, pds::merge_annotated);
+
+        std::vector<cartesian_product_type_t<merge_annotated_, decltype(vs)>> p;
+
+        pds::foreach_cartesian_product_by(vs, pds::merge_annotated, [&](auto const &e) {
+            std::cout << e << std::endl;
+            p.push_back(e);
+        });
+
+        Assert(p.size(), is_equal_to(ref.size()));
+
+        bool same = true;
+        for(size_t n = 0; n < p.size(); n++)
+            same = same && p[n].value == ref[n].value && p[n].info == ref[n].info;
+
+        Assert(same, is_true());
+
+        size_t n = 0;
+        pds::foreach_cartesian_product_by(vs, pds::merge_annotated, [&](auto const &) { n++; }, 1, 3);
+        Assert(n, is_equal_to(1UL));
+
+        // chunks of the product of the first two vectors
+
+        std::vector<cartesian_product_type_t<merge_annotated_, decltype(vs)>> q;
+
+        auto size = pds::cartesian_prefix_size(vs, 2);
+        for(size_t b = 0; b < size; b += 4)
+            pds::foreach_cartesian_product_by(vs, pds::merge_annotated, [&](auto const &e) { q.push_back(e); }, b, b + 4, 2);
+
+        bool chunked = q.size() == ref.size();
+        for(size_t n = 0; chunked && n < q.size(); n++)
+            chunked = q[n].value == ref[n].value && q[n].info == ref[n].info;
+
+        Assert(size, is_equal_to(6UL));
+        Assert(chunked, is_true());
+    })
+
     ;
 
 
@@ -0,0 +1,131 @@
+#include "pds/count_sketch.hpp"
+
+#include <iostream>
+#include <random>
+#include <unordered_map>
+#include <cmath>
+#include <algorithm>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using count_sketch_t = pds::count_sketch<int64_t, 1024, BIT_10(Wang7), BIT_10(H2), BIT_10(H3), BIT_10(H4), BIT_10(H5)>;
+
+
+auto g = Group("CountSketch")
+
+    .Single("sign", []
+    {
+        int pos = 0;
+        for(int n = 0; n < 10000; n++)
+            pos += count_sketch_t::sign(0, n) > 0;
+
+        Assert(pos, is_greater(4800));
+        Assert(pos, is_less(5200));
+
+        Assert(count_sketch_t::sign(1, std::make_tuple(1, 2)) == count_sketch_t::sign(1, std::make_tuple(1, 2)));
+    })
+
+    .Single("count", []
+    {
+        count_sketch_t s;
+
+        for(int n = 0; n < 100; n++)
+            s.increment_buckets(42);
+        s.increment_buckets(7, 30);
+        s.decrement_buckets(7, 10);
+
+        Assert(s.count(42), is_equal_to(100L));
+        Assert(s.count(7),  is_equal_to(20L));
+        Assert(s.count(11), is_equal_to(0L));
+
+        count_sketch_t t;
+        t.increment_buckets(42, 40);
+
+        int64_t row = 0;
+        for(size_t c = 0; c < t.size().second; c++)
+            row += std::abs(t.at(0, c));
+
+        Assert(t.size().first, is_equal_to(5UL));
+        Assert(row, is_equal_to(40L));
+
+        Assert((s - t).count(42), is_equal_to(60L));
+        Assert((s + t).count(42), is_equal_to(140L));
+
+        t.reset();
+        Assert(t.count(42), is_equal_to(0L));
+    })
+
+    .Single("unbiased", []
+    {
+        count_sketch_t s;
+        std::unordered_map<int, int64_t> truth;
+
+        std::mt19937 rand;
+        std::geometric_distribution<int> dist(0.001);
+
+        for(int n = 0; n < 200000; n++)
+        {
+            auto k = dist(rand);
+            s.increment_buckets(k);
+            truth[k]++;
+        }
+
+        double err = 0;
+        for(int k = 0; k < 100; k++)
+            err += s.count(k) - truth[k];
+
+        std::cout << "mean error: " << err / 100 << std::endl;
+
+        Assert(std::abs(err / 100), is_less(10.0));
+
+        long max_err = 0;
+        for(int k = 0; k < 10; k++)
+            max_err = std::max(max_err, std::abs(s.count(k) - truth[k]));
+
+        Assert(max_err, is_less(500L));
+    })
+
+    .Single("f2_inner_product", []
+    {
+        count_sketch_t a, b;
+        std::unordered_map<int, double> fa, fb;
+
+        std::mt19937 rand;
+        std::geometric_distribution<int> dist(0.01);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto k = dist(rand);
+            a.increment_buckets(k);
+            fa[k]++;
+
+            auto j = dist(rand);
+            b.increment_buckets(j);
+            fb[j]++;
+        }
+
+        double f2 = 0, join = 0;
+        for(auto & e : fa)
+        {
+            f2 += e.second * e.second;
+            join += e.second * fb[e.first];
+        }
+
+        std::cout << "F2: " << f2 << " estimated " << a.f2() << std::endl;
+        std::cout << "join: " << join << " estimated " << a.inner_product(b) << std::endl;
+
+        Assert(std::abs(a.f2() - f2) / f2, is_less(0.05));
+        Assert(std::abs(a.inner_product(b) - join) / join, is_less(0.05));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,197 @@
+#include "pds/ddsketch.hpp"
+#include "pds/sketch.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <limits>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+double exact_quantile(std::vector<double> const &sorted, double q)
+{
+    return sorted[static_cast<size_t>(q * (sorted.size() - 1))];
+}
+
+
+double relative_error(double x, double ref)
+{
+    return std::abs(x - ref) / ref;
+}
+
+
+auto g = Group("DDSketch")
+
+    .Single("small", []
+    {
+        pds::ddsketch<> d;
+
+        Assert(std::isnan(d.quantile(0.5)), is_true());
+
+        for(int n = 1; n <= 100; n++)
+            d(n);
+
+        Assert(d.count(), is_equal_to(100UL));
+        Assert(d.quantile(0), is_equal_to(1.0));
+        Assert(d.quantile(1), is_equal_to(100.0));
+        Assert(relative_error(d.quantile(0.5), 50), is_less(0.01));
+        Assert(d.rank(0.5), is_equal_to(0.0));
+        Assert(d.rank(100), is_equal_to(1.0));
+        Assert(std::abs(d.rank(50) - 0.5), is_less(0.02));
+    })
+
+    .Single("zero_negative", []
+    {
+        pds::ddsketch<> d(0.02);
+
+        for(int n = 0; n < 10; n++)
+            d(0.0);
+        for(int n = 1; n <= 10; n++)
+            d(n);
+
+        Assert(d.zero_count(), is_equal_to(10UL));
+        Assert(d.quantile(0.25), is_equal_to(0.0));
+        Assert(relative_error(d.quantile(0.75), 5), is_less(0.02));
+
+        AssertThrow(d(-1.0));
+        AssertThrow(d(std::nan("")));
+        AssertThrow(d(std::numeric_limits<double>::infinity()));
+        AssertThrow(pds::ddsketch<>(0.0));
+        AssertThrow(pds::ddsketch<>(1.0));
+
+        Assert(d.count(), is_equal_to(20UL));
+    })
+
+    .Single("relative_error", []
+    {
+        pds::ddsketch<> d(0.01);
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::lognormal_distribution<double> dist(3.0, 2.0);
+
+        for(int n = 0; n < 1000000; n++)
+        {
+            auto x = dist(rand);
+            d(x);
+            v.push_back(x);
+        }
+
+        std::sort(std::begin(v), std::end(v));
+
+        std::cout << "buckets: " << d.buckets() << ", " << sizeof(d) << " bytes" << std::endl;
+
+        double err = 0;
+        for(auto q : {0.001, 0.01, 0.25, 0.5, 0.75, 0.99, 0.999, 0.9999})
+        {
+            auto x = d.quantile(q);
+            std::cout << "q " << q << " => " << x << " (exact " << exact_quantile(v, q) << ")" << std::endl;
+            err = std::max(err, relative_error(x, exact_quantile(v, q)));
+        }
+
+        Assert(err, is_less(0.01 * (1 + 1e-9)));
+    })
+
+    .Single("outliers", []
+    {
+        // a narrow dense window around the hot range, a few timeouts and a
+        // spread of fast outliers that overflow the sparse store: the low tail
+        // is collapsed upward, the upper quantiles keep the relative error
+
+        pds::ddsketch<64, 16> d(0.01);
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::normal_distribution<double> hot(100, 5);
+        std::uniform_real_distribution<double> fast(0.001, 1);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto x = n % 100 == 1 ? fast(rand) : n % 100 == 2 ? 1000 * (1 + n % 10) : hot(rand);
+            d(x);
+            v.push_back(x);
+        }
+
+        std::sort(std::begin(v), std::end(v));
+
+        Assert(d.buckets(), is_less(64UL + 16 + 1));
+
+        double err = 0;
+        for(auto q : {0.25, 0.5, 0.9, 0.985, 0.995})
+            err = std::max(err, relative_error(d.quantile(q), exact_quantile(v, q)));
+
+        Assert(err, is_less(0.01 * (1 + 1e-9)));
+        Assert(d.quantile(0.005), is_greater_equal(exact_quantile(v, 0.005)));
+        Assert(d.max(), is_equal_to(v.back()));
+    })
+
+    .Single("merge", []
+    {
+        pds::ddsketch<> a, b, c, ref;
+
+        std::mt19937 rand;
+        std::exponential_distribution<double> dist(0.1);
+
+        b(1e6);     // anchors b far away from a
+        ref(1e6);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto x = dist(rand), y = 100 + dist(rand);
+            a(x);
+            b(y);
+            ref(x);
+            ref(y);
+        }
+
+        c = a + b;
+        a += b;
+
+        Assert(a.count(), is_equal_to(200001UL));
+        Assert(c.count(), is_equal_to(200001UL));
+        Assert(a.buckets(), is_equal_to(ref.buckets()));
+
+        bool same = true;
+        for(auto q : {0.01, 0.25, 0.5, 0.75, 0.99, 0.999})
+            same = same && a.quantile(q) == ref.quantile(q) && c.quantile(q) == ref.quantile(q);
+
+        Assert(same, is_true());
+
+        AssertThrow(a += pds::ddsketch<>(0.05));
+    })
+
+    .Single("sketch_cell", []
+    {
+        pds::sketch<pds::ddsketch<256, 16>, 16, BIT_4(std::hash<int>), BIT_4(H2)> s;
+
+        std::mt19937 rand;
+        std::exponential_distribution<double> slow(0.01), fast(1.0);
+
+        for(int n = 0; n < 10000; n++)
+        {
+            s.foreach_bucket(1, [&](auto &d) { d(fast(rand)); });
+            s.foreach_bucket(2, [&](auto &d) { d(slow(rand)); });
+        }
+
+        Assert(s.minsum(), is_equal_to(20000UL));
+
+        auto idx = s.indexes([](auto const &d, uint64_t) { return d.count() > 0 && d.quantile(0.99) > 100; });
+
+        Assert(idx[0].size(), is_equal_to(1UL));
+        Assert(idx[1].size(), is_equal_to(1UL));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,102 @@
+#include "pds/decayed_sketch.hpp"
+#include "pds/reversible.hpp"
+
+#include <iostream>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("DecayedSketch")
+
+    .Single("half_life", []
+    {
+        pds::decayed_sketch<1024, BIT_10(std::hash<int>), BIT_10(H2)> s(std::log(2.0) / 10);
+
+        for(int i = 0; i < 1000; i++)
+            s.increment_buckets(1, 0.0);
+
+        Assert(std::abs(s.count(1, 0.0)  - 1000.0), is_less(1e-6));
+        Assert(std::abs(s.count(1, 10.0) -  500.0), is_less(1e-6));
+        Assert(std::abs(s.count(1, 20.0) -  250.0), is_less(1e-6));
+
+        s.update(1, 10.0, 500.0);
+        Assert(std::abs(s.count(1) - 1000.0), is_less(1e-6));
+        Assert(s.count(2), is_equal_to(0.0));
+    })
+
+    .Single("landmark", []
+    {
+        pds::decayed_sketch<1024, BIT_10(std::hash<int>), BIT_10(H2)> s(1.0);
+
+        s.increment_buckets(1, 0.0);
+        s.increment_buckets(2, 0.0);
+
+        // far beyond the max exponent: a new landmark is taken...
+
+        s.increment_buckets(1, 100.0);
+        s.increment_buckets(1, 100.0);
+
+        Assert(std::abs(s.count(1) - 2.0), is_less(1e-9));
+        Assert(std::abs(s.count(1, 101.0) - 2.0 * std::exp(-1.0)), is_less(1e-9));
+        Assert(s.count(2), is_less(1e-40));
+
+        s.increment_buckets(2, 1000.0);
+        Assert(std::abs(s.count(2) - 1.0), is_less(1e-9));
+        Assert(std::abs(s.minsum() - 1.0), is_less(1e-9));
+    })
+
+    .Single("epochs", []
+    {
+        pds::decayed_sketch<1024, BIT_10(std::hash<int>), BIT_10(H2)> s(1.0);
+
+        s.increment_buckets(1, 0.0);
+
+        // many landmarks: counters older than the previous epoch count as zero...
+
+        for(int t = 1; t <= 10000; t++)
+            s.increment_buckets(2, t * 100.0);
+
+        s.increment_buckets(3, 1000000.0 - 1.0);
+        s.increment_buckets(3, 1000000.0);
+
+        Assert(s.count(1), is_equal_to(0.0));
+        Assert(std::abs(s.count(2) - 1.0), is_less(1e-9));
+        Assert(std::abs(s.count(3) - (1.0 + std::exp(-1.0))), is_less(1e-9));
+    })
+
+    .Single("reverse", []
+    {
+        pds::decayed_sketch< 65536
+                           , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                           , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                           > s(0.1);
+
+        // an old heavy hitter and a recent one of lower volume...
+
+        for(int i = 0; i < 1000; i++)
+            s.increment_buckets(std::make_tuple(0xaa, 0xbb), 0.0);
+
+        for(int i = 0; i < 200; i++)
+            s.increment_buckets(std::make_tuple(0xcc, 0xdd), 100.0);
+
+        auto idx = s.indexes([](double b, double sum) { return b > sum / 2; });
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(s.counters(), idx);
+
+        for(auto & t: res)
+            std::cout << "candidate => " << t.value << std::endl;
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0xcc, 0xdd));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,109 @@
+#include "pds/dyadic.hpp"
+#include "pds/range.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using dyadic_t = pds::dyadic_sketch<uint64_t, 16, 1024, BIT_10(Wang7), BIT_10(HalfAvalanche), BIT_10(WangHalfAvalanche)>;
+
+
+auto g = Group("Dyadic")
+
+    .Single("range_count", []
+    {
+        dyadic_t s;
+
+        for(uint64_t p = 0; p < 1024; p++)
+            s.update(p * 64, 2);
+
+        Assert(s.total(), is_equal_to(2048UL));
+        Assert(s.count(128), is_greater_equal(2UL));
+
+        Assert(s.range_count(0, 65535), is_equal_to(2048UL));
+        Assert(s.range_count(0, 1 << 20), is_equal_to(2048UL));
+        Assert(s.range_count(65535, 0), is_equal_to(0UL));
+
+        // exact on the levels without hashing
+
+        Assert(s.range_count(0, 32767), is_equal_to(1024UL));
+        Assert(s.range_count(1024, 2047), is_equal_to(32UL));
+
+        // unaligned ranges
+
+        auto r = s.range_count(100, 20000);
+        Assert(r, is_greater_equal(2UL * (20000/64 - 1)));
+        Assert(r, is_less(2UL * (20000/64 - 1) + 20));
+
+        Assert(s.range_count(numeric_range<uint16_t>(1024, 2047)), is_equal_to(32UL));
+        Assert(s.range_count(numeric_range<int>(-5, 127)), is_equal_to(s.range_count(0, 127)));
+        Assert(s.range_count(numeric_range<int>(-100, -5)), is_equal_to(0UL));
+    })
+
+    .Single("quantile", []
+    {
+        dyadic_t s;
+        std::vector<uint64_t> v;
+
+        std::mt19937 rand;
+        std::normal_distribution<double> dist(20000, 3000);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto x = static_cast<uint64_t>(std::max(0.0, std::min(65535.0, dist(rand))));
+            s(x);
+            v.push_back(x);
+        }
+
+        std::sort(std::begin(v), std::end(v));
+
+        double max_err = 0;
+        for(auto phi : {0.01, 0.25, 0.5, 0.75, 0.99})
+        {
+            auto q = s.quantile(phi);
+            auto rank = std::lower_bound(std::begin(v), std::end(v), q) - std::begin(v);
+
+            std::cout << "phi " << phi << " => " << q << " (exact " << v[static_cast<size_t>(phi * v.size())] << ")" << std::endl;
+
+            max_err = std::max(max_err, std::abs(static_cast<double>(rank) / v.size() - phi));
+        }
+
+        Assert(max_err, is_less(0.01));
+
+        Assert(s.quantile(0.0), is_less(v.front() + 1));
+    })
+
+    .Single("merge", []
+    {
+        dyadic_t a, b;
+
+        for(int n = 0; n < 100; n++) {
+            a(80);
+            b(443);
+        }
+
+        auto c = a + b;
+
+        Assert(c.total(), is_equal_to(200UL));
+        Assert(c.range_count(0, 100), is_equal_to(100UL));
+        Assert(c.quantile(0.5), is_equal_to(80UL));
+        Assert(c.quantile(0.51), is_equal_to(443UL));
+
+        c.reset();
+        Assert(c.range_count(0, 65535), is_equal_to(0UL));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
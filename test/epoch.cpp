@@ -0,0 +1,137 @@
+#include "pds/epoch.hpp"
+#include "pds/sketch.hpp"
+#include "pds/hyperloglog.hpp"
+
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <chrono>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using sketch_t = pds::sketch<uint32_t, 1024, BIT_10(std::hash<int>), BIT_10(H2)>;
+
+
+auto g = Group("Epoch")
+
+    .Single("rotate", []
+    {
+        pds::epoch_rotating<sketch_t> e;
+
+        Assert(static_cast<bool>(e.snapshot()), is_false());
+
+        e.current().increment_buckets(1);
+        e.current().increment_buckets(1);
+        e.rotate();
+
+        e.current().increment_buckets(2);
+
+        {
+            auto s = e.snapshot();
+            Assert(static_cast<bool>(s), is_true());
+            Assert(s.epoch(), is_equal_to(0ULL));
+            Assert(s->count(1), is_equal_to(2U));
+            Assert(s->count(2), is_equal_to(0U));
+        }
+
+        e.rotate();
+
+        auto s = e.snapshot();
+        Assert(s.epoch(), is_equal_to(1ULL));
+        Assert(s->count(1), is_equal_to(0U));
+        Assert(s->count(2), is_equal_to(1U));
+
+        Assert(e.collect(), is_equal_to(1UL));
+        Assert(e.collect(), is_equal_to(0UL));
+
+        e.rotate();
+        Assert(e.current().count(1), is_equal_to(0U));
+        Assert(e.current().count(2), is_equal_to(0U));
+    })
+
+    .Single("lazy_clear", []
+    {
+        pds::epoch_rotating<hyperloglog<uint8_t, 64, std::hash<int>>, 4> e;
+
+        for(int i = 0; i < 16; i++)
+        {
+            for(int n = 0; n < 1000; n++)
+                e.current()(n);
+            e.rotate();
+        }
+
+        hyperloglog<uint8_t, 64, std::hash<int>> ref;
+        for(int n = 0; n < 1000; n++)
+            ref(n);
+
+        auto s = e.snapshot();
+        Assert(s->cardinality(), is_equal_to(ref.cardinality()));
+        Assert(e.current().cardinality(), is_equal_to(0.0));
+    })
+
+    .Single("concurrent", []
+    {
+        pds::epoch_rotating<sketch_t> e;
+
+        e.start_collector();
+
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> reads{0}, errors{0};
+
+        std::vector<std::thread> readers;
+
+        for(int r = 0; r < 3; r++)
+        {
+            readers.emplace_back([&] {
+                while (!stop.load())
+                {
+                    auto s = e.snapshot();
+                    if (!s)
+                        continue;
+
+                    // every interval holds exactly 100 hits of the key 42:
+                    // a snapshot being cleared under the reader would break it.
+
+                    for(int n = 0; n < 10; n++)
+                    {
+                        if (s->count(42) != 100)
+                            errors++;
+                    }
+                    reads++;
+                    s.release();
+                    std::this_thread::yield();
+                }
+            });
+        }
+
+        for(int i = 0; i < 500; i++)
+        {
+            for(int n = 0; n < 100; n++)
+                e.current().increment_buckets(42);
+            e.rotate();
+
+            std::this_thread::sleep_for(std::chrono::microseconds(20));
+        }
+
+        stop = true;
+        for(auto & t : readers)
+            t.join();
+
+        std::cout << "epochs: " << e.epoch() << " snapshot reads: " << reads << std::endl;
+
+        Assert(errors.load(), is_equal_to(0UL));
+        Assert(e.epoch(), is_equal_to(500ULL));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,139 @@
+#include "pds/forecast.hpp"
+#include "pds/reversible.hpp"
+
+#include <iostream>
+#include <random>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using sketch_t = pds::sketch< uint32_t
+                            , 65536
+                            , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                            , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                            , pds::ModularHash< BIT_8(H3), BIT_8(H3)>
+                            >;
+
+using ewma_t = pds::ewma_forecast< 65536
+                                 , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                                 , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                                 , pds::ModularHash< BIT_8(H3), BIT_8(H3)>
+                                 >;
+
+using holt_t = pds::holt_winters_forecast< 65536
+                                         , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                                         , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                                         , pds::ModularHash< BIT_8(H3), BIT_8(H3)>
+                                         >;
+
+//
+// one interval of traffic: 200 keys with about 100 + growth * t hits each
+//
+
+template <typename Rand>
+sketch_t interval(Rand &rand, int t, int growth = 0)
+{
+    sketch_t s;
+    std::uniform_int_distribution<int> noise(-5, 5);
+
+    for(int k = 0; k < 200; k++)
+    {
+        auto n = 100 + growth * t + noise(rand);
+        for(int i = 0; i < n; i++)
+            s.increment_buckets(std::make_tuple<uint8_t, uint8_t>(k, k * 7));
+    }
+
+    return s;
+}
+
+
+auto g = Group("Forecast")
+
+    .Single("zip_apply", []
+    {
+        sketch_t a, b;
+        pds::sketch<double, 65536, pds::ModularHash< BIT_8(H1), BIT_8(H1)>,
+                                   pds::ModularHash< BIT_8(H2), BIT_8(H2)>,
+                                   pds::ModularHash< BIT_8(H3), BIT_8(H3)>> c;
+
+        a.increment_buckets(std::make_tuple<uint8_t, uint8_t>(1, 2));
+        b.increment_buckets(std::make_tuple<uint8_t, uint8_t>(1, 2));
+        b.increment_buckets(std::make_tuple<uint8_t, uint8_t>(1, 2));
+
+        zip_apply([](double &r, uint32_t x, uint32_t y) { r = 0.5 * x + 2.0 * y; }, c, a, b);
+
+        Assert(c.count(std::make_tuple<uint8_t, uint8_t>(1, 2)), is_equal_to(4.5));
+        Assert(c.count(std::make_tuple<uint8_t, uint8_t>(3, 4)), is_equal_to(0.0));
+    })
+
+    .Single("ewma", []
+    {
+        std::mt19937 rand;
+        ewma_t fc(0.5);
+
+        bool quiet = true;
+        for(int t = 0; t < 8; t++)
+        {
+            auto s = interval(rand, t);
+            if (t == 7)
+                for(int i = 0; i < 2000; i++)
+                    s.increment_buckets(std::make_tuple<uint8_t, uint8_t>(0xba, 0xbe));
+
+            fc.update(s);
+
+            if (t > 0 && t < 7)
+                quiet = quiet && fc.anomalies(0.5) == Indices(3);
+        }
+
+        Assert(quiet, is_true());
+
+        Assert(fc.intervals(), is_equal_to(8UL));
+
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(fc.error(), fc.anomalies(0.5));
+
+        for(auto & t: res)
+            std::cout << "anomaly => " << t << std::endl;
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0xba, 0xbe));
+        Assert(std::abs(fc.error(res.front().value) - 2000), is_less(10.0));
+    })
+
+    .Single("holt_winters", []
+    {
+        std::mt19937 rand;
+        holt_t fc(0.8, 0.5);
+
+        for(int t = 0; t < 10; t++)
+            fc.update(interval(rand, t, 20));
+
+        // the trend is followed: errors stay within the noise
+
+        auto key = std::make_tuple<uint8_t, uint8_t>(10, 70);
+
+        Assert(std::abs(fc.error(key)), is_less(20.0));
+        Assert(std::abs(fc.forecast(key) - (100 + 20 * 10)), is_less(20.0));
+
+        auto s = interval(rand, 10, 20);
+        for(int i = 0; i < 1000; i++)
+            s.increment_buckets(std::make_tuple<uint8_t, uint8_t>(0xca, 0xfe));
+
+        fc.update(s);
+
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(fc.error(), fc.anomalies(0.5));
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0xca, 0xfe));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,108 @@
+#include "pds/hhh.hpp"
+
+#include <iostream>
+#include <random>
+
+#include <arpa/inet.h>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using hhh_t = pds::hhh_sketch<uint32_t, 5, Wang7, H2, H3, H4>;
+
+
+std::string
+show(hhh_t::entry const &e)
+{
+    in_addr a { htonl(e.prefix) };
+    return std::string(inet_ntoa(a)) + "/" + std::to_string(e.length) + " count " + std::to_string(e.count) + " discounted " + std::to_string(e.discounted);
+}
+
+
+auto g = Group("HHH")
+
+    .Single("prefix", []
+    {
+        auto t = pds::ip_prefix_tuple<2>(0x01020304);
+        Assert(std::get<0>(t), is_equal_to(1));
+        Assert(std::get<1>(t), is_equal_to(2));
+
+        hhh_t s;
+        s.update(0x01020304, 10);
+        s.update(0x01020305, 5);
+
+        Assert(s.count(0x01020304, 32), is_equal_to(10U));
+        Assert(s.count(0x01020300, 24), is_equal_to(15U));
+        Assert(s.count(0x01020000, 16), is_equal_to(15U));
+        Assert(s.count(0x01000000, 8),  is_equal_to(15U));
+        Assert(s.total(), is_equal_to(15UL));
+
+        // the levels are plain sketches indexed by the prefix tuple
+
+        Assert(s.level<3>().count(pds::ip_prefix_tuple<3>(0x01020300)), is_equal_to(15U));
+    })
+
+    .Single("hhh", []
+    {
+        hhh_t s;
+        std::mt19937 rand;
+
+        for(int n = 0; n < 3000; n++)
+            s(0x01020304);                      // 1.2.3.4/32
+        for(int n = 0; n < 3000; n++)
+            s(0x05060700 | (rand() & 0xff));    // 5.6.7.0/24
+        for(int n = 0; n < 4000; n++)
+            s(rand());                          // background
+
+        auto res = s.hhh_fraction(0.1);
+
+        for(auto & e : res)
+            std::cout << "HHH => " << show(e) << std::endl;
+
+        Assert(res.size(), is_equal_to(2UL));
+
+        Assert(res[0].prefix, is_equal_to(0x01020304U));
+        Assert(res[0].length, is_equal_to(32UL));
+        Assert(res[0].count,  is_greater_equal(3000U));
+
+        Assert(res[1].prefix, is_equal_to(0x05060700U));
+        Assert(res[1].length, is_equal_to(24UL));
+        Assert(res[1].discounted, is_greater_equal(3000U));
+    })
+
+    .Single("discounted", []
+    {
+        hhh_t a, b;
+
+        for(int n = 0; n < 600; n++)
+            a(0x0a000001);                      // 10.0.0.1
+        for(int n = 0; n < 300; n++)
+            b(0x0a000002);                      // 10.0.0.2
+        for(int n = 0; n < 300; n++)
+            b(0x0a000003);                      // 10.0.0.3
+
+        auto s = a + b;
+
+        auto res = s.hhh(500);
+
+        for(auto & e : res)
+            std::cout << "HHH => " << show(e) << std::endl;
+
+        Assert(res.size(), is_equal_to(2UL));
+        Assert(res[0].prefix, is_equal_to(0x0a000001U));
+        Assert(res[1].prefix, is_equal_to(0x0a000000U));
+        Assert(res[1].length, is_equal_to(24UL));
+        Assert(res[1].count,  is_equal_to(1200U));
+        Assert(res[1].discounted, is_equal_to(600U));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,152 @@
+#include "pds/kll.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+template <typename Sketch>
+double max_rank_error(Sketch const &s, std::vector<double> sorted)
+{
+    std::sort(std::begin(sorted), std::end(sorted));
+
+    double err = 0;
+    for(auto phi = 0.01; phi < 1.0; phi += 0.01)
+    {
+        auto q = s.quantile(phi);
+        auto r = static_cast<double>(std::upper_bound(std::begin(sorted), std::end(sorted), q) - std::begin(sorted)) / sorted.size();
+        err = std::max(err, std::abs(r - phi));
+    }
+    return err;
+}
+
+
+auto g = Group("KLL")
+
+    .Single("small", []
+    {
+        pds::kll_sketch<int> s;
+
+        Assert(s.quantile(0.5), is_equal_to(0));
+
+        for(int n = 1; n <= 100; n++)
+            s(n);
+
+        // no compaction yet: exact
+
+        Assert(s.n(), is_equal_to(100UL));
+        Assert(s.quantile(0.5), is_equal_to(50));
+        Assert(s.quantile(0.0), is_equal_to(1));
+        Assert(s.quantile(1.0), is_equal_to(100));
+        Assert(s.rank(25), is_equal_to(0.25));
+        Assert(s.min(), is_equal_to(1));
+        Assert(s.max(), is_equal_to(100));
+    })
+
+    .Single("accuracy", []
+    {
+        pds::kll_sketch<double> s;
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::lognormal_distribution<double> dist(3.0, 1.0);
+
+        for(int n = 0; n < 1000000; n++)
+        {
+            auto x = dist(rand);
+            s(x);
+            v.push_back(x);
+        }
+
+        auto err = max_rank_error(s, v);
+
+        std::cout << "levels " << s.num_levels() << " retained " << s.retained() << " max rank error " << err << std::endl;
+
+        Assert(err, is_less(0.015));
+        Assert(s.retained(), is_less(1000UL));
+        Assert(s.quantile(1.0), is_equal_to(*std::max_element(std::begin(v), std::end(v))));
+    })
+
+    .Single("merge", []
+    {
+        pds::kll_sketch<double> a(1), b(2), ref;
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::uniform_real_distribution<double> da(0, 100), db(50, 200);
+
+        for(int n = 0; n < 200000; n++)
+        {
+            auto x = da(rand), y = db(rand);
+            a(x);
+            b(y);
+            v.push_back(x);
+            v.push_back(y);
+        }
+
+        auto c = a + b;
+
+        Assert(c.n(), is_equal_to(400000UL));
+        Assert(c.min(), is_equal_to(*std::min_element(std::begin(v), std::end(v))));
+
+        auto err = max_rank_error(c, v);
+        std::cout << "merged: levels " << c.num_levels() << " retained " << c.retained() << " max rank error " << err << std::endl;
+
+        Assert(err, is_less(0.02));
+
+        ref += c;
+        Assert(ref.n(), is_equal_to(400000UL));
+        Assert(ref.quantile(0.5), is_equal_to(c.quantile(0.5)));
+    })
+
+    .Single("benchmark", []
+    {
+        const size_t N = 1000000;
+
+        std::vector<double> v(N);
+        std::mt19937 rand;
+        std::exponential_distribution<double> dist(0.01);
+        for(auto &x : v)
+            x = dist(rand);
+
+        pds::kll_sketch<double> s;
+
+        auto start = std::chrono::steady_clock::now();
+        for(auto x : v)
+            s(x);
+        auto p99 = s.quantile(0.99);
+        auto end = std::chrono::steady_clock::now();
+
+        auto kll_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        start = std::chrono::steady_clock::now();
+        std::vector<double> exact;
+        for(auto x : v)
+            exact.push_back(x);
+        std::nth_element(std::begin(exact), std::begin(exact) + N * 99 / 100, std::end(exact));
+        auto exact_p99 = exact[N * 99 / 100];
+        end = std::chrono::steady_clock::now();
+
+        auto exact_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+
+        std::cout << "kll:         " << static_cast<double>(kll_ns) / N << " ns/op, " << s.memory() << " bytes, p99 " << p99 << std::endl;
+        std::cout << "nth_element: " << static_cast<double>(exact_ns) / N << " ns/op, " << exact.capacity() * sizeof(double) << " bytes, p99 " << exact_p99 << std::endl;
+
+        Assert(s.memory(), is_less(exact.capacity() * sizeof(double)));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
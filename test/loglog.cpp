@@ -8,6 +8,7 @@
 #include <tuple>
 #include <iostream>
 #include <random>
+#include <cmath>
 
 #include <yats.hpp>
 
@@ -132,6 +133,43 @@ auto h = Group("Hyper")
             std::cout << (n+1) << ": -> " << llc.cardinality() << std::endl;
         }
     })
+    .Single("joint", []
+    {
+        using hll_t = pds::hyperloglog<uint8_t, 4096, pds::Mix64>;
+
+        auto make = [](uint64_t first, uint64_t last) {
+            hll_t h;
+            for(auto x = first; x < last; ++x)
+                h(x);
+            return h;
+        };
+
+        auto a = make(0, 100000), b = make(50000, 150000);
+
+        auto e = pds::joint_cardinality(a, b);
+        auto ie = a.cardinality() + b.cardinality() - (a + b).cardinality();
+
+        std::cout << "A\\B: " << e.a_only << " B\\A: " << e.b_only << " A&B: " << e.intersection
+                  << " (inclusion-exclusion: " << ie << ", exact: 50000)" << std::endl;
+
+        Assert(std::abs(e.intersection - 50000) / 50000, is_less(0.1));
+        Assert(std::abs(e.a_only - 50000) / 50000, is_less(0.1));
+        Assert(std::abs(pds::jaccard(a, b) - 1.0/3), is_less(0.05));
+
+        // disjoint, identical and nested sets
+
+        auto c = make(1000000, 1100000);
+        Assert(pds::intersection_cardinality(a, c) / (a + c).cardinality(), is_less(0.05));
+        Assert(pds::jaccard(a, a), is_greater(0.95));
+
+        auto d = make(0, 5000);
+        auto n = pds::joint_cardinality(a, d);
+        std::cout << "A\\D: " << n.a_only << " D\\A: " << n.b_only << " A&D: " << n.intersection << std::endl;
+
+        Assert(std::abs(pds::difference_cardinality(a, d) - 95000) / 95000, is_less(0.1));
+        Assert(std::abs(n.intersection - 5000) / 5000, is_less(0.2));
+        Assert(n.b_only, is_less(500.0));
+    })
     ;
 
 
@@ -0,0 +1,122 @@
+#include "pds/minhash.hpp"
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+template <typename MH>
+MH make_set(uint64_t first, uint64_t last)
+{
+    MH m;
+    for(auto x = first; x < last; ++x)
+        m(x);
+    return m;
+}
+
+
+auto g = Group("MinHash")
+
+    .Single("jaccard", []
+    {
+        auto a = make_set<pds::minhash<256>>(0, 10000);
+        auto b = make_set<pds::minhash<256>>(5000, 15000);
+        auto c = make_set<pds::minhash<256>>(20000, 30000);
+
+        std::cout << "J(a,b) = " << a.jaccard(b) << " (exact " << 1.0/3 << ")" << std::endl;
+
+        Assert(a.empty_bins(), is_equal_to(0UL));
+        Assert(std::abs(a.jaccard(b) - 1.0/3), is_less(0.1));
+        Assert(a.jaccard(a), is_equal_to(1.0));
+        Assert(a.jaccard(c), is_less(0.05));
+
+        pds::minhash<256> e;
+        Assert(e.jaccard(e), is_equal_to(1.0));
+        Assert(e.jaccard(a), is_equal_to(0.0));
+    })
+
+    .Single("densification", []
+    {
+        // sets much smaller than K leave most of the bins empty
+
+        auto a = make_set<pds::minhash<1024>>(0, 40);
+        auto b = make_set<pds::minhash<1024>>(20, 60);
+        auto c = make_set<pds::minhash<1024>>(100, 140);
+
+        Assert(a.empty_bins(), is_greater(900UL));
+
+        auto s = a.signature();
+        Assert(std::count(std::begin(s), std::end(s), pds::minhash<1024>::empty_bin), is_equal_to(0L));
+
+        std::cout << "J(a,b) = " << a.jaccard(b) << " (exact " << 1.0/3 << ")" << std::endl;
+
+        Assert(std::abs(a.jaccard(b) - 1.0/3), is_less(0.1));
+        Assert(a.jaccard(c), is_less(0.05));
+    })
+
+    .Single("bbit", []
+    {
+        auto a = make_set<pds::minhash<1024>>(0, 100000);
+        auto b = make_set<pds::minhash<1024>>(50000, 150000);
+
+        auto sa = a.bbit_signature<4>();
+        auto sb = b.bbit_signature<4>();
+
+        Assert(sizeof(sa), is_equal_to(1024UL * 4 / 8));
+
+        auto j = pds::bbit_jaccard<1024, 4>(sa, sb);
+        std::cout << "4-bit J(a,b) = " << j << " (full " << a.jaccard(b) << ")" << std::endl;
+
+        Assert(std::abs(j - 1.0/3), is_less(0.1));
+        Assert(pds::bbit_jaccard<1024, 4>(sa, sa), is_equal_to(1.0));
+        Assert(pds::bbit_jaccard<1024, 1>(a.bbit_signature<1>(), b.bbit_signature<1>()), is_greater(0.2));
+    })
+
+    .Single("merge", []
+    {
+        auto a = make_set<pds::minhash<128>>(0, 5000);
+        auto b = make_set<pds::minhash<128>>(3000, 8000);
+        auto u = make_set<pds::minhash<128>>(0, 8000);
+
+        Assert(pds::minhash<128>::jaccard((a + b).signature(), u.signature()), is_equal_to(1.0));
+
+        a += b;
+        Assert(a.jaccard(u), is_equal_to(1.0));
+
+        a.reset();
+        Assert(a.empty_bins(), is_equal_to(128UL));
+    })
+
+    .Single("range", []
+    {
+        std::vector<std::string> v;
+        for(int n = 0; n < 1000; n++)
+            v.push_back("flow" + std::to_string(n));
+
+        pds::minhash<64, std::hash<std::string>> a, b;
+
+        a.update(std::begin(v), std::end(v));
+        for(auto & s : v)
+            b(s);
+
+        bool same = true;
+        for(size_t i = 0; i < a.size(); i++)
+            same = same && a.bin(i) == b.bin(i);
+
+        Assert(same, is_true());
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -2,12 +2,15 @@
 #include "pds/hash.hpp"
 #include "pds/range.hpp"
 #include "pds/sketch.hpp"
+#include "pds/sketch_query.hpp"
 #include "pds/reversible.hpp"
 #include "pds/cartesian.hpp"
 #include "pds/mangling.hpp"
 #include "pds/hyperloglog.hpp"
 #include "pds/loglog.hpp"
 #include "pds/stat.hpp"
+#include "pds/space_saving.hpp"
+#include "pds/spread_sketch.hpp"
 
 #include <pcap/pcap.h>
 
@@ -78,6 +81,18 @@ pds::sketch< std::set<std::tuple<uint32_t, uint16_t, uint16_t>>
 std::unordered_map<uint32_t, std::set<std::tuple<uint32_t, uint32_t, uint32_t> > > actual_map;
 
 
+pds::space_saving<uint32_t, 1024> packet_summary;   // packets per destination
+
+
+std::unordered_map<uint32_t, uint64_t> actual_packets;
+
+
+pds::spread_sketch<uint32_t, 4, 2048> spread_summary;   // distinct flows per destination
+
+
+stat::entropy<64> src_entropy, dst_entropy, port_entropy;   // per interval (the whole trace)
+
+
 void
 packet_handler(u_char *, const struct pcap_pkthdr *h, const u_char *payload)
 {
@@ -86,6 +101,12 @@ packet_handler(u_char *, const struct pcap_pkthdr *h, const u_char *payload)
 
     auto ip = reinterpret_cast<const iphdr *>(payload + 14);
 
+    packet_summary(ip->daddr);
+    actual_packets[ip->daddr]++;
+
+    src_entropy(ip->saddr);
+    dst_entropy(ip->daddr);
+
     switch(ip->protocol) {
 
     case 6: { // TCP
@@ -111,6 +132,9 @@ packet_handler(u_char *, const struct pcap_pkthdr *h, const u_char *payload)
             s.insert(std::make_tuple(pds::mangling<8191>(src_ip), src_port, dst_port));
         });
 
+        spread_summary(ip->daddr, std::make_tuple(src_ip, src_port, dst_port));
+        port_entropy(dst_port);
+
     } break;
 
     case 17: { // UDP
@@ -137,6 +161,9 @@ packet_handler(u_char *, const struct pcap_pkthdr *h, const u_char *payload)
             s.insert(std::make_tuple(pds::mangling<8191>(src_ip), src_port, dst_port));
         });
 
+        spread_summary(ip->daddr, std::make_tuple(src_ip, src_port, dst_port));
+        port_entropy(dst_port);
+
     } break;
 
     }
@@ -188,6 +215,14 @@ auto g = Group("PCAP")
 		s.insert(std::make_tuple(src_ip, src_port, dst_port));
             });
 
+	    spread_summary(dst_ip, std::make_tuple(src_ip, src_port, dst_port));
+	    src_entropy(src_ip);
+	    dst_entropy(dst_ip);
+	    port_entropy(dst_port);
+
+	    packet_summary(dst_ip);
+	    actual_packets[dst_ip]++;
+
 	    // insert fake hitter in the deterministic map 
 	    //
    	    
@@ -228,15 +263,16 @@ auto g = Group("PCAP")
 
 	// dump buckets...
 
-	auto minsum = llc_sketch.minsum();
+	auto query  = pds::make_query(llc_sketch);
+	auto minsum = query.minsum();
 	std::cout << "Total minsum: " << minsum;
 
 	std::cout  << std::endl;
 
 	// Sketch<HLL>
 	{
-		auto idx = llc_sketch.indexes([=](auto &b, auto) { 
-				bool ret = (100.0 * b.cardinality() / minsum) >= perc;	
+		auto idx = query.indexes([=](double card, uint64_t) { 
+				bool ret = (100.0 * card / minsum) >= perc;	
 				return ret;
 			   });
 
@@ -253,9 +289,8 @@ auto g = Group("PCAP")
 		    auto it = actual_map.find(tuple2ip<8191>(t.value));
 		    if (it != actual_map.end()) { 
 
-			auto v = llc_sketch.buckets(t.info);  
-			std::vector<size_t> buckets;
-			std::transform(v.begin(), v.end(), std::back_inserter(buckets), [](auto &b) { return b.cardinality(); });
+			auto v = query.buckets(t.info);  
+			std::vector<size_t> buckets(v.begin(), v.end());
 
 			std::cout << "  candidate (HLL) -> " << inet_ntoa({tuple2ip<8191>(t.value)}) << " " << *std::min_element(buckets.begin(), buckets.end()) << std::endl;
             		top_candidate[tuple2ip<8191>(t.value)] = *std::min_element(buckets.begin(), buckets.end());
@@ -322,6 +357,68 @@ auto g = Group("PCAP")
    
     std::cout << "NRMSD (HLL) => " << nrmsd_hllc.value() << std::endl; 
 
+    //
+    // distinct flows per destination: SpreadSketch, no reversing
+    //
+
+    {
+	std::cout << "+ querying spread sketch..." << std::endl;
+
+	auto start = std::chrono::system_clock::now();
+	auto res = spread_summary.superspreaders(perc / 100 * spread_summary.total());
+	auto end = std::chrono::system_clock::now();
+
+	size_t found = 0;
+	stat::MAPE mape_spread;
+
+	for(auto &e : res)
+	{
+	    auto it = top_hitter.find(e.first);
+	    if (it != top_hitter.end()) {
+		found++;
+		mape_spread(e.second, static_cast<double>(it->second));
+	    }
+
+	    if (perc > 0)
+		std::cout << "  candidate (spread) -> " << inet_ntoa({e.first}) << " " << e.second << std::endl;
+	}
+
+	std::cout << "Candidates found (spread): " << found << "/" << top_hitter.size() << " hitters, " << (res.size() - found) << " false positives" << std::endl;
+	std::cout << "Query done in " << std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() << " usec" << std::endl;
+	std::cout << "MAPE (spread) => " << mape_spread.value() << std::endl;
+    }
+
+    //
+    // packets per destination: Space-Saving summary
+    //
+
+    stat::MAPE mape_ss;
+
+    std::cout << "Space-Saving (packets, error <= " << packet_summary.total() / 1024 << "):" << std::endl;
+
+    for(auto &e : packet_summary.top(10))
+	std::cout << "  top -> " << inet_ntoa({e.key}) << " " << e.count << " (+/- " << e.error << ") actual " << actual_packets[e.key] << std::endl;
+
+    for(auto &e : packet_summary.top())
+	mape_ss(static_cast<double>(e.count), static_cast<double>(actual_packets[e.key]));
+
+    std::cout << "MAPE (Space-Saving) => " << mape_ss.value() << std::endl; 
+
+    //
+    // traffic features entropy (nats)
+    //
+
+    double dst_exact = 0, packets = 0;
+
+    for(auto &e : actual_packets)
+	packets += e.second;
+    for(auto &e : actual_packets)
+	dst_exact -= e.second / packets * std::log(e.second / packets);
+
+    std::cout << "Entropy src ip => " << src_entropy.value() << std::endl;
+    std::cout << "Entropy dst port => " << port_entropy.value() << std::endl;
+    std::cout << "Entropy dst ip => " << dst_entropy.value() << " (exact " << dst_exact << ")" << std::endl;
+
     size_t map_bytes = 0;
 
     for(auto &elem : actual_map)
@@ -332,6 +429,7 @@ auto g = Group("PCAP")
     std::cout << "\nMEMORY: " << mem << " bytes (" << (static_cast<double>(mem)/ (1024*1024)) << " MB)" << std::endl;
     std::cout << "DETERMINISTIC MEMORY: " << map_bytes << " bytes (" << (static_cast<double>(map_bytes)/ (1024*1024)) << " MB)" << std::endl;
     std::cout << "Commpression factor: " << (static_cast<double>(map_bytes)/mem) << std::endl;
+    std::cout << "SPREAD SKETCH MEMORY: " << spread_summary.memory() << " bytes (" << (static_cast<double>(spread_summary.memory())/ (1024*1024)) << " MB)" << std::endl;
 
 
 });
@@ -0,0 +1,163 @@
+#include "pds/reservoir.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("Reservoir")
+
+    .Single("fill", []
+    {
+        pds::reservoir<int, 10> r;
+
+        for(int n = 0; n < 5; n++)
+            r(n);
+
+        Assert(r.size(), is_equal_to(5UL));
+        Assert(std::accumulate(r.begin(), r.end(), 0), is_equal_to(10));
+
+        for(int n = 5; n < 10; n++)
+            r(n);
+
+        Assert(r.size(), is_equal_to(10UL));
+        Assert(std::accumulate(r.begin(), r.end(), 0), is_equal_to(45));
+
+        for(int n = 10; n < 100000; n++)
+            r(n);
+
+        Assert(r.size(), is_equal_to(10UL));
+        Assert(r.count(), is_equal_to(100000UL));
+        Assert(r.eval(), is_equal_to(100000UL));
+        Assert(r.skip(), is_greater(0UL));
+
+        r.reset();
+        Assert(r.size(), is_equal_to(0UL));
+    })
+
+    .Single("uniform", []
+    {
+        // inclusion frequency per decile of the stream, over many reservoirs
+
+        std::vector<double> decile(10);
+
+        for(uint64_t seed = 1; seed <= 200; seed++)
+        {
+            pds::reservoir<int, 100> r(seed);
+            for(int n = 0; n < 10000; n++)
+                r(n);
+
+            for(auto x : r)
+                decile[x / 1000] += 1.0 / (200 * 100);
+        }
+
+        double err = 0;
+        for(auto d : decile)
+            err = std::max(err, std::abs(d - 0.1));
+
+        std::cout << "max decile deviation: " << err << std::endl;
+
+        Assert(err, is_less(0.01));
+    })
+
+    .Single("batch", []
+    {
+        std::vector<int> v(100000);
+        std::iota(std::begin(v), std::end(v), 0);
+
+        pds::reservoir<int, 64> a(42), b(42);
+
+        a.update(std::begin(v), std::end(v));
+        for(auto x : v)
+            b(x);
+
+        Assert(a.count(), is_equal_to(b.count()));
+        Assert(std::equal(a.begin(), a.end(), b.begin()), is_true());
+    })
+
+    .Single("merge", []
+    {
+        // shards of 1000 and 9000 elements: 10% of the merged sample from the first
+
+        double from_a = 0;
+        bool full = true;
+
+        for(uint64_t seed = 1; seed <= 200; seed++)
+        {
+            pds::reservoir<int, 100> a(seed), b(seed + 1000);
+
+            for(int n = 0; n < 1000; n++)
+                a(n);
+            for(int n = 1000; n < 10000; n++)
+                b(n);
+
+            auto c = a + b;
+            full = full && c.size() == 100;
+
+            from_a += std::count_if(c.begin(), c.end(), [](int x) { return x < 1000; }) / (200.0 * 100);
+        }
+
+        std::cout << "fraction from the first shard: " << from_a << std::endl;
+
+        Assert(full, is_true());
+        Assert(std::abs(from_a - 0.1), is_less(0.01));
+    })
+
+    .Single("priority", []
+    {
+        std::mt19937 rand;
+        std::lognormal_distribution<double> dist(0.0, 2.0);
+
+        std::vector<double> w;
+        for(int n = 0; n < 100000; n++)
+            w.push_back(dist(rand));
+
+        auto total = std::accumulate(std::begin(w), std::end(w), 0.0);
+        auto heavy = *std::max_element(std::begin(w), std::end(w));
+
+        double even = 0;
+        for(size_t n = 0; n < w.size(); n += 2)
+            even += w[n];
+
+        pds::priority_sample<size_t, 1000> a(1), b(2);
+
+        for(size_t n = 0; n < w.size(); n++)
+            (n < 30000 ? a : b)(n, w[n]);
+
+        auto p = a + b;
+
+        bool has_heavy = false;
+        p.foreach_sample([&](size_t i, double, double) { has_heavy = has_heavy || w[i] == heavy; });
+
+        std::cout << "total: " << p.total() << " (exact " << total << "), tau: " << p.threshold() << std::endl;
+
+        Assert(p.size(), is_equal_to(1000UL));
+        Assert(p.count(), is_equal_to(100000UL));
+        Assert(has_heavy, is_true());
+        Assert(std::abs(p.total() - total) / total, is_less(0.1));
+        Assert(std::abs(p.subset_sum([](size_t i) { return i % 2 == 0; }) - even) / even, is_less(0.15));
+
+        pds::priority_sample<int, 4> s;
+        s(1, 1.0);
+        s(2, 0.0);
+        s(3, 2.0);
+
+        Assert(s.threshold(), is_equal_to(0.0));
+        Assert(s.total(), is_equal_to(3.0));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
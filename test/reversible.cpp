@@ -4,6 +4,7 @@
 #include "pds/cartesian.hpp"
 
 #include <iostream>
+#include <numeric>
 
 #include <yats.hpp>
 
@@ -90,6 +91,125 @@ auto g = Group("Reversible")
         for(auto & t: res)
             std::cout << "candidate => " << t << std::endl;
     })
+    .Single("bucket_set", []
+    {
+        auto layout = std::make_shared<const pds::bucket_layout>(Indices{ std::vector<size_t>{1, 8, 42, 30023}
+                                                                        , std::vector<size_t>{2, 9} });
+        pds::bucket_set s1(layout), s2(layout);
+
+        s1.set(0, 1); s1.set(0, 3); s1.set(1, 0);
+        s2.set(0, 3); s2.set(1, 0); s2.set(1, 1);
+
+        auto m = pds::merge_indices(s1, s2);
+        Assert(static_cast<bool>(m), is_true());
+        Assert(m->to_indices() == Indices{ std::vector<size_t>{30023}, std::vector<size_t>{2} });
+        Assert(m->count(0), is_equal_to(1UL));
+
+        pds::bucket_set s3(layout);
+        s3.set(0, 0); s3.set(1, 0);
+
+        Assert(static_cast<bool>(pds::merge_indices(s1, s3)), is_false());
+        Assert(static_cast<bool>(pds::merge_indices(s1, s3, 1)), is_true());
+        Assert(pds::merge_indices(s1, s3, 1)->empty(0), is_true());
+    })
+
+    .Single("inverse_table", []
+    {
+        pds::sketch< int
+                   , (1 << 12)
+                   , pds::ModularHash< BIT_6(H1), BIT_6(H1)>
+                   , pds::ModularHash< BIT_6(H2), BIT_6(H2)>
+                   , pds::ModularHash< BIT_6(H3), BIT_6(H3)> > s;
+
+        s.increment_buckets(std::make_tuple(0xbad, 0xbee));
+        s.increment_buckets(std::make_tuple(0xdead, 0xbeef));
+        s.increment_buckets(std::make_tuple(42, 0xcafe));
+
+        auto idx = s.indexes([](int b, uint64_t) { return b > 0; });
+
+        std::vector<uint16_t> words(0x10000);
+        std::iota(std::begin(words), std::end(words), 0);
+
+        // numeric ranges go through the inverse tables, other ranges are scanned...
+
+        auto t0 = pds::candidates<0>(s, pds::numeric_range<uint16_t>(0, 0xffff), idx);
+        auto s0 = pds::candidates<0>(s, words, idx);
+        auto t1 = pds::candidates<1>(s, pds::numeric_range<uint16_t>(0, 0xffff), idx);
+        auto s1 = pds::candidates<1>(s, words, idx);
+
+        auto same = [](auto const &a, auto const &b) {
+            return a.size() == b.size() &&
+                std::equal(std::begin(a), std::end(a), std::begin(b), [](auto const &x, auto const &y) {
+                        return x.value == y.value && x.info == y.info;
+                    });
+        };
+
+        Assert(t0.size(), is_greater(0UL));
+        Assert(t1.size(), is_greater(0UL));
+        Assert(same(t0, s0), is_true());
+        Assert(same(t1, s1), is_true());
+
+        auto res = pds::reverse_sketch<uint16_t, uint16_t>(s, idx);
+        for(auto & t: res)
+            std::cout << "candidate => " << t.value << std::endl;
+        
+        Assert(res.size(), is_greater_equal(3UL));
+
+        // ranges too large for an inverse table are scanned
+
+        Assert(pds::range_size(pds::numeric_range<uint16_t>(0, 0xffff)), is_equal_to(0x10000UL));
+        Assert(pds::range_size(pds::numeric_range<int8_t>(-128, 127)), is_equal_to(256UL));
+        Assert(pds::range_size(pds::make_range<uint32_t>::run()), is_equal_to(1UL << 32));
+
+        auto l0 = pds::candidates<0>(s, pds::numeric_range<uint32_t>(0, (1 << 24) + 0xff), idx);
+
+        Assert(l0.size(), is_greater_equal(t0.size()));
+        Assert(std::equal(std::begin(t0), std::end(t0), std::begin(l0), [](auto const &x, auto const &y) {
+                    return x.value == y.value && x.info == y.info;
+               }), is_true());
+    })
+    .Single("parallel", []
+    {
+        pds::sketch< int
+                   , (1 << 12)
+                   , pds::ModularHash< BIT_4(H1), BIT_4(H1), BIT_4(H1)>
+                   , pds::ModularHash< BIT_4(H2), BIT_4(H2), BIT_4(H2)> > s;
+
+        for(int i = 0; i < 64; i++)
+            s.increment_buckets(std::make_tuple(i, i * 3, i * 7));
+
+        auto idx = s.indexes([](int b, uint64_t) { return b > 0; });
+
+        auto seq = pds::reverse_sketch<uint8_t, uint8_t, uint8_t>(s, idx);
+        auto par = pds::parallel_reverse_sketch<uint8_t, uint8_t, uint8_t>(s, idx, 4);
+
+        std::cout << "candidates: " << seq.size() << std::endl;
+
+        Assert(par.size(), is_equal_to(seq.size()));
+        Assert(std::equal(std::begin(seq), std::end(seq), std::begin(par), [](auto const &x, auto const &y) {
+                    return x.value == y.value && x.info == y.info;
+                }), is_true());
+
+        // few candidates in the first component: the chunks span the next ones
+
+        pds::sketch< int
+                   , (1 << 12)
+                   , pds::ModularHash< BIT_4(H1), BIT_4(H1), BIT_4(H1)>
+                   , pds::ModularHash< BIT_4(H2), BIT_4(H2), BIT_4(H2)> > s1;
+
+        for(int i = 0; i < 64; i++)
+            s1.increment_buckets(std::make_tuple(42, i * 3, i * 7));
+
+        auto idx1 = s1.indexes([](int b, uint64_t) { return b > 0; });
+
+        auto seq1 = pds::reverse_sketch<uint8_t, uint8_t, uint8_t>(s1, idx1);
+        auto par1 = pds::parallel_reverse_sketch<uint8_t, uint8_t, uint8_t>(s1, idx1, 8);
+
+        Assert(par1.size(), is_equal_to(seq1.size()));
+        Assert(std::equal(std::begin(seq1), std::end(seq1), std::begin(par1), [](auto const &x, auto const &y) {
+                    return x.value == y.value && x.info == y.info;
+                }), is_true());
+    })
     ;
 
 
@@ -0,0 +1,112 @@
+#include "pds/shm_sketch.hpp"
+#include "pds/reversible.hpp"
+#include "pds/range.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using shm_sketch_t = pds::shm_sketch< uint32_t
+                                    , 65536
+                                    , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                                    , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                                    >;
+
+auto g = Group("ShmSketch")
+
+    .Single("create_open", []
+    {
+        shm_sketch_t::unlink("/pds-test-create");
+
+        shm_sketch_t w("/pds-test-create", shm_mode::create);
+        shm_sketch_t r("/pds-test-create", shm_mode::read_only);
+
+        w.increment_buckets(std::make_tuple(1, 2));
+        w.increment_buckets(std::make_tuple(1, 2));
+        w.increment_buckets(std::make_tuple(3, 4));
+
+        Assert(r.count(std::make_tuple(1, 2)), is_equal_to(2U));
+        Assert(r.count(std::make_tuple(3, 4)), is_equal_to(1U));
+        Assert(r.count(std::make_tuple(5, 6)), is_equal_to(0U));
+        Assert(r.minsum(), is_equal_to(3ULL));
+
+        auto s = r.snapshot();
+        Assert(s.count(std::make_tuple(1, 2)), is_equal_to(2U));
+
+        w.reset();
+        Assert(r.count(std::make_tuple(1, 2)), is_equal_to(0U));
+
+        shm_sketch_t::unlink("/pds-test-create");
+    })
+
+    .Single("layout_mismatch", []
+    {
+        using other_t = pds::shm_sketch<uint32_t, 1024, BIT_10(H1)>;
+
+        shm_sketch_t::unlink("/pds-test-layout");
+        shm_sketch_t w("/pds-test-layout", shm_mode::create);
+
+        AssertThrow(other_t("/pds-test-layout", shm_mode::open));
+        AssertThrow(other_t("/pds-test-no-such-segment", shm_mode::open));
+
+        shm_sketch_t::unlink("/pds-test-layout");
+    })
+
+    .Single("multi_process", []
+    {
+        shm_sketch_t::unlink("/pds-test-fork");
+        shm_sketch_t w("/pds-test-fork", shm_mode::create);
+
+        auto pid = ::fork();
+        if (pid == 0)
+        {
+            shm_sketch_t producer("/pds-test-fork", shm_mode::open);
+
+            for(int i = 0; i < 1000; i++)
+            {
+                producer.increment_buckets(std::make_tuple(0xba, 0xbe));
+                if (i % 10 == 0)
+                    producer.increment_buckets(std::make_tuple(i & 0xff, 42));
+            }
+
+            ::_exit(0);
+        }
+
+        int status;
+        ::waitpid(pid, &status, 0);
+
+        shm_sketch_t reader("/pds-test-fork", shm_mode::read_only);
+
+        Assert(reader.count(std::make_tuple(0xba, 0xbe)), is_greater_equal(1000U));
+
+        auto idx = reader.indexes([](uint32_t b, uint64_t) {
+                                    return b >= 1000;
+                                  });
+
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(reader, idx);
+
+        for(auto & t: res)
+            std::cout << "candidate => " << t << std::endl;
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0xba, 0xbe));
+
+        shm_sketch_t::unlink("/pds-test-fork");
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
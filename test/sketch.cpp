@@ -1,5 +1,7 @@
 #include "pds/sketch.hpp"
 #include "pds/range.hpp"
+#include "pds/sketch_query.hpp"
+#include "pds/hyperloglog.hpp"
 
 #include <iostream>
 #include <stdexcept>
@@ -238,6 +240,49 @@ auto g = Group("Sketch")
 
 
     })
+    .Single("query", []
+    {
+        pds::sketch<uint32_t, 1024, BIT_10(std::hash<int>), BIT_10(H2)> sk;
+
+        for(int n = 0; n < 100; n++)
+            sk.increment_buckets(n);
+        for(int n = 0; n < 50; n++)
+            sk.increment_buckets(7);
+
+        auto sums = sk.row_sums();
+        Assert(sums[0], is_equal_to(150UL));
+        Assert(sums[1], is_equal_to(150UL));
+        Assert(sk.minsum(), is_equal_to(150UL));
+
+        auto q = pds::make_query(sk);
+
+        Assert(q.minsum(), is_equal_to(sk.minsum()));
+        Assert(q.row_sums()[1], is_equal_to(150UL));
+
+        auto pred = [](uint32_t b, uint64_t sum) { return b * 10 > sum; };
+
+        Assert(q.indexes(pred) == sk.indexes(pred));
+        Assert(q.buckets(q.indexes(pred)) == sk.buckets(sk.indexes(pred)));
+    })
+
+    .Single("query_hll", []
+    {
+        pds::sketch<hyperloglog<uint8_t, 64, std::hash<int>>, 16, BIT_4(std::hash<int>), BIT_4(H2)> sk;
+
+        for(int n = 0; n < 1000; n++)
+            sk.foreach_bucket(n % 3, [n](auto &hll) { hll(n); });
+
+        auto q = pds::make_query(sk);
+
+        Assert(q.minsum(), is_equal_to(sk.minsum()));
+
+        auto idx = q.indexes([](double card, uint64_t sum) { return card * 4 > sum; });
+        auto ref = sk.indexes([](auto const &b, uint64_t sum) { return b.cardinality() * 4 > sum; });
+
+        Assert(idx == ref);
+        Assert(q(0, idx[0].front()), is_equal_to(sk(0, idx[0].front()).cardinality()));
+    })
+
     .Single("compile-time error", []
     {
         // using Hash1 = pds::sketch<uint32_t, 1024, std::hash<uint32_t>, pds::ModularHash<64, std::hash<uint32_t>, std::hash<uint32_t>> >;
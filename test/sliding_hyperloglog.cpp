@@ -0,0 +1,109 @@
+#include "pds/sliding_hyperloglog.hpp"
+#include "pds/hyperloglog.hpp"
+#include "pds/sketch.hpp"
+#include "pds/reversible.hpp"
+
+#include <iostream>
+#include <random>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("SlidingHyperLogLog")
+
+    .Single("window", []
+    {
+        pds::sliding_hyperloglog<1024, std::hash<std::string>, 100> shll;
+
+        for(int n = 0; n < 100000; n++)
+            shll("elem" + std::to_string(n), n / 1000);
+
+        bool same = true;
+        for(uint64_t w : {1, 10, 50, 100})
+        {
+            pds::hyperloglog<uint8_t, 1024, std::hash<std::string>> hll;
+
+            for(int n = 0; n < 100000; n++)
+                if (n / 1000 > 99 - static_cast<int>(w))
+                    hll("elem" + std::to_string(n));
+
+            std::cout << "window " << w << ": " << shll.cardinality(w) << " (hll: " << hll.cardinality() << ")" << std::endl;
+
+            same = same && shll.cardinality(w) == hll.cardinality();
+        }
+
+        Assert(same, is_true());
+
+        AssertThrow(shll.cardinality(10, 50));
+
+        shll.expire(1000);
+        Assert(shll.cardinality(), is_equal_to(0.0));
+    })
+
+    .Single("merge", []
+    {
+        pds::sliding_hyperloglog<256, std::hash<int>, 10> a, b;
+        pds::hyperloglog<uint8_t, 256, std::hash<int>> ref;
+
+        for(int n = 0; n < 10000; n++)
+        {
+            if (n & 1)
+                a(n, n / 1000);
+            else
+                b(n, n / 1000);
+
+            if (n / 1000 > 4)
+                ref(n);
+        }
+
+        a += b;
+        Assert(a.cardinality(5), is_equal_to(ref.cardinality()));
+    })
+
+    .Single("sketch", []
+    {
+        using shll_t = pds::sliding_hyperloglog<64, std::hash<std::tuple<uint16_t, uint16_t>>, 60>;
+
+        pds::sketch< shll_t
+                   , (1 << 16)
+                   , pds::ModularHash<BIT_8(H1), BIT_8(H1)>
+                   , pds::ModularHash<BIT_8(H2), BIT_8(H2)>
+                   , pds::ModularHash<BIT_8(H3), BIT_8(H3)>
+                   > s;
+
+        // a scan in the old past and a scan in the last 10 seconds...
+
+        for(int i = 0; i < 20000; i++)
+        {
+            uint64_t t = i < 10000 ? 0 : 55;
+
+            s.foreach_bucket(std::make_tuple(i < 10000 ? 0x11 : 0x22, 0x33), [&](auto &shll)
+            {
+                shll(std::tuple<uint16_t, uint16_t>{20, i}, t);
+            });
+        }
+
+        auto idx = s.indexes([](auto &b, auto)
+                             {
+                                return b.cardinality(10, 60) > 5000;
+                             });
+
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(s, idx);
+
+        for(auto & t: res)
+            std::cout << "candidate => " << t << std::endl;
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0x22, 0x33));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,86 @@
+#include "pds/sliding_sketch.hpp"
+#include "pds/reversible.hpp"
+#include "pds/range.hpp"
+
+#include <iostream>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("SlidingSketch")
+
+    .Single("window", []
+    {
+        pds::sliding_sketch<uint32_t, 1024, 3, BIT_10(std::hash<int>), BIT_10(H2)> s;
+
+        s.increment_buckets(1);
+        s.increment_buckets(1);
+        Assert(s.count(1), is_equal_to(2U));
+
+        s.advance();
+        s.increment_buckets(1);
+        s.increment_buckets(2);
+        Assert(s.count(1), is_equal_to(3U));
+        Assert(s.count(2), is_equal_to(1U));
+        Assert(s.current().count(1), is_equal_to(1U));
+
+        s.advance();
+        s.increment_buckets(2);
+        Assert(s.count(1), is_equal_to(3U));
+        Assert(s.count(2), is_equal_to(2U));
+
+        s.advance();    // the first sub-interval expires...
+        Assert(s.count(1), is_equal_to(1U));
+        Assert(s.count(2), is_equal_to(2U));
+
+        s.advance_to(4);
+        Assert(s.count(1), is_equal_to(0U));
+        Assert(s.count(2), is_equal_to(1U));
+
+        s.advance_to(100);
+        Assert(s.count(2), is_equal_to(0U));
+        Assert(s.minsum(), is_equal_to(0ULL));
+        Assert(s.tick(), is_equal_to(100ULL));
+    })
+
+    .Single("reverse", []
+    {
+        pds::sliding_sketch< uint32_t
+                           , 65536
+                           , 4
+                           , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                           , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                           > s;
+
+        for(int t = 0; t < 8; t++)
+        {
+            auto key = t < 4 ? std::make_tuple(0xaa, 0xbb) : std::make_tuple(0xcc, 0xdd);
+
+            for(int i = 0; i < 100; i++)
+                s.increment_buckets(key);
+
+            s.increment_buckets(std::make_tuple(t, t));
+            s.advance();
+        }
+
+        auto idx = s.indexes([](uint32_t b, uint64_t) { return b >= 300; });
+
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(s.window(), idx);
+
+        for(auto & t: res)
+            std::cout << "candidate => " << t.value << std::endl;
+
+        Assert(res.size(), is_equal_to(1UL));
+        Assert(res.front().value == std::make_tuple<uint8_t, uint8_t>(0xcc, 0xdd));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
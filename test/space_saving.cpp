@@ -0,0 +1,111 @@
+#include "pds/space_saving.hpp"
+
+#include <iostream>
+#include <random>
+#include <unordered_map>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("SpaceSaving")
+
+    .Single("exact", []
+    {
+        pds::space_saving<int, 8> s;
+
+        for(int n = 0; n < 5; n++)
+            for(int i = 0; i <= n; i++)
+                s(n);
+
+        Assert(s.size(), is_equal_to(5UL));
+        Assert(s.total(), is_equal_to(15UL));
+        Assert(s.count(4), is_equal_to(5UL));
+        Assert(s.error(4), is_equal_to(0UL));
+        Assert(s.min_count(), is_equal_to(0UL));
+
+        auto top = s.top(3);
+        Assert(top.size(), is_equal_to(3UL));
+        Assert(top[0].key, is_equal_to(4));
+        Assert(top[1].key, is_equal_to(3));
+        Assert(top[2].key, is_equal_to(2));
+    })
+
+    .Single("bounds", []
+    {
+        pds::space_saving<uint32_t, 64> s;
+        std::unordered_map<uint32_t, uint64_t> truth;
+
+        std::mt19937 rand;
+        std::geometric_distribution<uint32_t> dist(0.05);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto k = dist(rand);
+            s(k);
+            truth[k]++;
+        }
+
+        s.update(0xdead, 20000);
+        truth[0xdead] += 20000;
+
+        auto top = s.top();
+        Assert(top.size(), is_equal_to(64UL));
+        Assert(top.front().key, is_equal_to(0xdeadU));
+
+        bool sorted = true;
+        for(size_t i = 1; i < top.size(); i++)
+            sorted = sorted && top[i-1].count >= top[i].count;
+
+        Assert(sorted, is_true());
+
+        bool upper = true, lower = true, bounded = true;
+        for(auto & e : top)
+        {
+            upper   = upper   && e.count >= truth[e.key];
+            lower   = lower   && e.count - e.error <= truth[e.key];
+            bounded = bounded && e.error <= s.total() / 64;
+        }
+
+        Assert(upper, is_true());
+        Assert(lower, is_true());
+        Assert(bounded, is_true());
+
+        bool frequent = true;
+        for(auto & e : s.frequent(0.01))
+            frequent = frequent && e.count > s.total() / 100;
+
+        Assert(frequent, is_true());
+    })
+
+    .Single("merge", []
+    {
+        pds::space_saving<int, 4> a, b;
+
+        a.update(1, 100); a.update(2, 50); a.update(3, 10); a.update(4, 5);
+        b.update(1, 20);  b.update(5, 70); b.update(6, 30); b.update(7, 1);
+
+        auto c = a + b;
+
+        Assert(c.total(), is_equal_to(286UL));
+
+        auto top = c.top();
+        Assert(top.size(), is_equal_to(4UL));
+        Assert(top[0].key, is_equal_to(1));
+        Assert(top[0].count, is_equal_to(120UL));
+        Assert(top[1].key, is_equal_to(5));
+        Assert(top[1].count, is_equal_to(75UL));
+        Assert(top[1].error, is_equal_to(5UL));
+        Assert(top[2].key, is_equal_to(2));
+        Assert(top[2].count, is_equal_to(51UL));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,132 @@
+#include "pds/spread_sketch.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using spread_t = pds::spread_sketch<uint32_t, 4, 2048>;
+
+
+double relative_error(double x, double ref)
+{
+    return std::abs(x - ref) / ref;
+}
+
+
+auto g = Group("SpreadSketch")
+
+    .Single("bitmap", []
+    {
+        // the multiresolution bitmap over a wide range: mean error of 20 keys
+
+        double err = 0;
+
+        for(uint64_t n : {10, 100, 1000, 10000, 100000})
+        {
+            double sum = 0;
+
+            for(uint32_t k = 0; k < 20; k++)
+            {
+                pds::spread_sketch<uint32_t, 1, 1, 12> s;
+
+                for(uint64_t i = 0; i < n; i++)
+                {
+                    s(k, i);
+                    s(k, i);
+                }
+
+                sum += relative_error(s.spread(k), n);
+            }
+
+            std::cout << n << " => mean error " << sum / 20 << std::endl;
+            err = std::max(err, sum / 20);
+        }
+
+        Assert(err, is_less(0.15));
+    })
+
+    .Single("superspreaders", []
+    {
+        spread_t s;
+        std::mt19937 rand;
+
+        std::set<uint32_t> heavy = { 7, 99, 1234, 50000, 77777 };
+
+        size_t total = 0;
+
+        for(auto k : heavy)
+        {
+            for(uint32_t e = 0; e < 2000 + k % 5000; e++)
+                s(k, std::make_tuple(e, k));
+            total += 2000 + k % 5000;
+        }
+
+        std::set<std::pair<uint32_t, uint32_t>> noise;
+
+        for(int n = 0; n < 200000; n++)
+        {
+            auto k = 100000 + rand() % 10000;       // up to 20 elements per key
+            auto e = rand() % 20;
+            s(k, e);
+            noise.emplace(k, e);
+        }
+
+        total += noise.size();
+
+        auto res = s.superspreaders(1000);
+
+        std::set<uint32_t> found;
+        double err = 0;
+
+        for(auto & e : res)
+        {
+            std::cout << "superspreader -> " << e.first << " " << e.second << std::endl;
+            found.insert(e.first);
+            err += relative_error(e.second, 2000 + e.first % 5000) / res.size();
+        }
+
+        Assert(found == heavy);
+        Assert(err, is_less(0.15));
+        Assert(relative_error(s.total(), total), is_less(0.25));
+        Assert(s.spread(100001), is_less(200.0));
+    })
+
+    .Single("merge", []
+    {
+        spread_t a, b, u;
+
+        for(uint32_t e = 0; e < 3000; e++)
+        {
+            a(1, e);
+            b(1, e + 1500);
+            u(1, e);
+            u(1, e + 1500);
+        }
+
+        Assert((a + b).spread(1), is_equal_to(u.spread(1)));
+
+        a += b;
+        Assert(a.spread(1), is_equal_to(u.spread(1)));
+        Assert(relative_error(a.spread(1), 4500), is_less(0.2));
+        Assert(a.superspreaders(1000).size(), is_equal_to(1UL));
+
+        a.reset();
+        Assert(a.spread(1), is_equal_to(0.0));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
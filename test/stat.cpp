@@ -0,0 +1,88 @@
+#include "pds/stat.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+auto g = Group("Stat")
+
+    .Single("entropy_uniform", []
+    {
+        stat::entropy<256> e;
+
+        for(int i = 0; i < 100; i++)
+            for(uint64_t x = 0; x < 256; x++)
+                e(x);
+
+        std::cout << "entropy: " << e.value() << " (exact " << std::log(256) << ")" << std::endl;
+
+        Assert(e.m, is_equal_to(25600UL));
+        Assert(std::abs(e.value() - std::log(256)), is_less(0.25));
+    })
+
+    .Single("entropy_skewed", []
+    {
+        stat::entropy<256> e, single;
+
+        std::mt19937 rand;
+        std::geometric_distribution<uint64_t> dist(0.1);
+
+        std::vector<double> f(1024);
+        for(int n = 0; n < 100000; n++)
+        {
+            auto x = dist(rand);
+            e(x);
+            f[std::min<size_t>(x, f.size() - 1)]++;
+        }
+
+        double h = 0;
+        for(auto c : f)
+            if (c)
+                h -= c / 100000 * std::log(c / 100000);
+
+        std::cout << "entropy: " << e.value() << " (exact " << h << ")" << std::endl;
+
+        Assert(std::abs(e.value() - h), is_less(0.25));
+
+        for(int n = 0; n < 1000; n++)
+            single(42);
+
+        Assert(single.value(), is_less(0.01));
+    })
+
+    .Single("entropy_merge", []
+    {
+        stat::entropy<64> a, b, u;
+
+        for(uint64_t x = 0; x < 1000; x++)
+        {
+            a(x, 2);
+            b(x + 500);
+            u(x, 2);
+            u(x + 500);
+        }
+
+        a += b;
+
+        Assert(std::abs(a.value() - u.value()), is_less(1e-9));
+        Assert(a.m, is_equal_to(3000UL));
+
+        a.reset();
+        Assert(a.value(), is_equal_to(0.0));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
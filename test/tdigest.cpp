@@ -0,0 +1,161 @@
+#include "pds/tdigest.hpp"
+#include "pds/sketch.hpp"
+
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+double exact_quantile(std::vector<double> const &sorted, double q)
+{
+    return sorted[std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()))];
+}
+
+
+auto g = Group("TDigest")
+
+    .Single("small", []
+    {
+        pds::tdigest<> t;
+
+        Assert(std::isnan(t.quantile(0.5)), is_true());
+
+        for(int n = 1; n <= 10; n++)
+            t(n);
+
+        Assert(t.count(), is_equal_to(10.0));
+        Assert(t.quantile(0), is_equal_to(1.0));
+        Assert(t.quantile(1), is_equal_to(10.0));
+        Assert(t.quantile(0.5), is_equal_to(5.5));
+        Assert(t.cdf(0.5), is_equal_to(0.0));
+        Assert(t.cdf(10), is_equal_to(1.0));
+        Assert(t.centroids(), is_equal_to(10UL));
+    })
+
+    .Single("tails", []
+    {
+        pds::tdigest<> t;
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::lognormal_distribution<double> dist(3.0, 1.0);
+
+        for(int n = 0; n < 1000000; n++)
+        {
+            auto x = dist(rand);
+            t(x);
+            v.push_back(x);
+        }
+
+        std::sort(std::begin(v), std::end(v));
+
+        std::cout << "centroids: " << t.centroids() << ", " << sizeof(t) << " bytes" << std::endl;
+
+        double rank_err = 0, tail_err = 0;
+
+        for(auto q : {0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999, 0.9999})
+        {
+            auto e = exact_quantile(v, q);
+            auto a = t.quantile(q);
+            auto r = static_cast<double>(std::upper_bound(std::begin(v), std::end(v), a) - std::begin(v)) / v.size();
+
+            std::cout << "q " << q << " => " << a << " (exact " << e << ", rank " << r << ")" << std::endl;
+
+            rank_err = std::max(rank_err, std::abs(r - q));
+            if (q >= 0.99)
+                tail_err = std::max(tail_err, std::abs(a - e) / e);
+        }
+
+        Assert(rank_err, is_less(0.01));
+        Assert(tail_err, is_less(0.01));
+
+        Assert(t.centroids(), is_less(200UL));
+        Assert(std::abs(t.cdf(exact_quantile(v, 0.99)) - 0.99), is_less(0.001));
+    })
+
+    .Single("merge", []
+    {
+        pds::tdigest<> a, b;
+        std::vector<double> v;
+
+        std::mt19937 rand;
+        std::exponential_distribution<double> dist(0.1);
+
+        for(int n = 0; n < 100000; n++)
+        {
+            auto x = dist(rand), y = 100 + dist(rand);
+            a(x);
+            b(y);
+            v.push_back(x);
+            v.push_back(y);
+        }
+
+        Assert((a + b).count(), is_equal_to(200000.0));
+
+        a += b;
+        std::sort(std::begin(v), std::end(v));
+
+        Assert(a.count(), is_equal_to(200000.0));
+        Assert(a.max(), is_equal_to(v.back()));
+
+        double err = 0;
+        for(auto q : {0.25, 0.75, 0.999})
+            err = std::max(err, std::abs(a.quantile(q) - exact_quantile(v, q)) / exact_quantile(v, q));
+
+        Assert(err, is_less(0.02));
+    })
+
+    .Single("skewed_weights", []
+    {
+        pds::tdigest<10, 128> t;
+
+        // each weight dwarfs the sum of the lighter ones: the k2 scale would
+        // keep every value apart, more centroids than the capacity...
+
+        for(int i = 0; i < 64; i++)
+            t.update(i, std::pow(100, i));
+        for(int i = 0; i < 64; i++)
+            t.update(1000 + i, std::pow(100, 63 - i));
+
+        Assert(t.centroids(), is_less_equal(20UL));
+        Assert(t.quantile(0), is_equal_to(0.0));
+        Assert(t.quantile(1), is_equal_to(1063.0));
+        Assert(t.quantile(0.5), is_greater_equal(63.0));
+        Assert(t.quantile(0.5), is_less_equal(1000.0));
+    })
+
+    .Single("sketch_cell", []
+    {
+        pds::sketch<pds::tdigest<50, 32>, 16, BIT_4(std::hash<int>), BIT_4(H2)> s;
+
+        std::mt19937 rand;
+        std::exponential_distribution<double> slow(0.01), fast(1.0);
+
+        for(int n = 0; n < 10000; n++)
+        {
+            s.foreach_bucket(1, [&](auto &t) { t(fast(rand)); });
+            s.foreach_bucket(2, [&](auto &t) { t(slow(rand)); });
+        }
+
+        Assert(s.minsum(), is_equal_to(20000UL));
+
+        auto idx = s.indexes([](auto const &t, uint64_t) { return t.count() > 0 && t.quantile(0.99) > 100; });
+
+        Assert(idx[0].size(), is_equal_to(1UL));
+        Assert(idx[1].size(), is_equal_to(1UL));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
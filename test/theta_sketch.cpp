@@ -0,0 +1,119 @@
+#include "pds/theta_sketch.hpp"
+#include "pds/hyperloglog.hpp"
+
+#include <iostream>
+#include <string>
+#include <cmath>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using theta_t = pds::theta_sketch<4096>;
+
+
+theta_t make_set(uint64_t first, uint64_t last)
+{
+    theta_t t;
+    for(auto x = first; x < last; ++x)
+        t(x);
+    return t;
+}
+
+
+double relative_error(double x, double ref)
+{
+    return std::abs(x - ref) / ref;
+}
+
+
+auto g = Group("ThetaSketch")
+
+    .Single("exact", []
+    {
+        pds::theta_sketch<16, std::hash<std::string>> t;
+
+        for(int i = 0; i < 2; i++)
+            for(int n = 0; n < 10; n++)
+                t("elem" + std::to_string(n));
+
+        Assert(t.is_exact(), is_true());
+        Assert(t.estimate(), is_equal_to(10.0));
+        Assert(t.eval(), is_equal_to(10.0));
+        Assert(t.lower_bound(), is_equal_to(10.0));
+
+        t.reset();
+        Assert(t.estimate(), is_equal_to(0.0));
+    })
+
+    .Single("estimate", []
+    {
+        auto t = make_set(0, 1000000);
+
+        std::cout << "estimate: " << t.estimate() << " [" << t.lower_bound() << ", " << t.upper_bound() << "]"
+                  << " retained: " << t.retained() << std::endl;
+
+        Assert(t.is_exact(), is_false());
+        Assert(t.retained(), is_less(theta_t::capacity * 3 / 4));
+        Assert(relative_error(t.estimate(), 1000000), is_less(0.05));
+        Assert(t.lower_bound(), is_less(1000000.0));
+        Assert(t.upper_bound(), is_greater(1000000.0));
+    })
+
+    .Single("union", []
+    {
+        auto a = make_set(0, 100000);
+        auto b = make_set(50000, 150000);
+
+        Assert(relative_error((a + b).estimate(), 150000), is_less(0.05));
+
+        a += b;
+        Assert(relative_error(a.estimate(), 150000), is_less(0.05));
+
+        a += a;
+        Assert(relative_error(a.estimate(), 150000), is_less(0.05));
+    })
+
+    .Single("intersection", []
+    {
+        auto a = make_set(0, 100000);
+        auto b = make_set(50000, 150000);
+        auto c = make_set(1000000, 1100000);
+
+        auto i = intersection(a, b);
+        auto d = a_not_b(a, b);
+
+        std::cout << "A&B: " << i.estimate() << " A\\B: " << d.estimate() << " (exact: 50000)" << std::endl;
+
+        Assert(relative_error(i.estimate(), 50000), is_less(0.1));
+        Assert(relative_error(d.estimate(), 50000), is_less(0.1));
+        Assert(relative_error(a_not_b(b, a).estimate(), 50000), is_less(0.1));
+        Assert(intersection(a, c).estimate(), is_equal_to(0.0));
+        Assert(a_not_b(a, a).estimate(), is_equal_to(0.0));
+        Assert(intersection(a, a).estimate(), is_equal_to(a.estimate()));
+
+        // a small intersection, compared with the hyperloglog joint estimator
+
+        auto e = make_set(95000, 200000);
+
+        pds::hyperloglog<uint8_t, 4096, pds::Mix64> ha, he;
+        for(uint64_t x = 0; x < 100000; x++)
+            ha(x);
+        for(uint64_t x = 95000; x < 200000; x++)
+            he(x);
+
+        std::cout << "A&E: " << intersection(a, e).estimate() << " (hll: " << pds::intersection_cardinality(ha, he)
+                  << ", exact: 5000)" << std::endl;
+
+        Assert(relative_error(intersection(a, e).estimate(), 5000), is_less(0.3));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}
@@ -0,0 +1,112 @@
+#include "pds/topk.hpp"
+#include "pds/reversible.hpp"
+
+#include <iostream>
+#include <tuple>
+
+#include <yats.hpp>
+
+using namespace yats;
+using namespace pds;
+
+
+using flow_t = std::tuple<uint8_t, uint8_t>;
+
+using topk_sketch_t = pds::topk_sketch< flow_t, 4, uint32_t
+                                      , 65536
+                                      , pds::ModularHash< BIT_8(H1), BIT_8(H1)>
+                                      , pds::ModularHash< BIT_8(H2), BIT_8(H2)>
+                                      >;
+
+
+auto g = Group("TopK")
+
+    .Single("heap", []
+    {
+        pds::topk<int, 3> t;
+
+        t.update(1, 10);
+        t.update(2, 20);
+        t.update(3, 30);
+        Assert(t.threshold(), is_equal_to(10UL));
+
+        t.update(4, 5);
+        Assert(t.contains(4), is_false());
+
+        t.update(5, 40);
+        Assert(t.contains(1), is_false());
+        Assert(t.contains(5), is_true());
+        Assert(t.threshold(), is_equal_to(20UL));
+
+        t.update(2, 50);
+        Assert(t.threshold(), is_equal_to(30UL));
+
+        auto top = t.top();
+        Assert(top.size(), is_equal_to(3UL));
+        Assert(top[0].key, is_equal_to(2));
+        Assert(top[1].key, is_equal_to(5));
+        Assert(top[2].key, is_equal_to(3));
+    })
+
+    .Single("sketch", []
+    {
+        topk_sketch_t s;
+
+        for(int i = 0; i < 100; i++)
+        {
+            for(int n = 0; n < 50; n++)
+                s.increment_buckets(flow_t(n, n+1));
+
+            s.increment_buckets(flow_t(0xca, 0xfe), 10);
+            s.increment_buckets(flow_t(0xba, 0xbe), 20);
+        }
+
+        auto top = s.top();
+
+        for(auto & e : top)
+            std::cout << "heavy hitter => (" << int(std::get<0>(e.key)) << ' ' << int(std::get<1>(e.key)) << "): " << e.count << std::endl;
+
+        Assert(s.heavy_hitters().size(), is_equal_to(4UL));
+        Assert(top[0].key == flow_t(0xba, 0xbe));
+        Assert(top[0].count, is_equal_to(2000U));
+        Assert(top[1].key == flow_t(0xca, 0xfe));
+        Assert(top[1].count, is_equal_to(1000U));
+
+        // the same keys found by reversing the sketch
+
+        auto idx = s.indexes([](uint32_t b, uint64_t) { return b >= 1000; });
+        auto res = pds::reverse_sketch<uint8_t, uint8_t>(s.counters(), idx);
+
+        Assert(res.size(), is_equal_to(2UL));
+
+        s.reset();
+        Assert(s.heavy_hitters().size(), is_equal_to(0UL));
+    })
+
+    .Single("merge", []
+    {
+        topk_sketch_t a, b;
+
+        for(int n = 0; n < 30; n++)
+            a.increment_buckets(flow_t(1, 1));
+        for(int n = 0; n < 20; n++)
+            b.increment_buckets(flow_t(1, 1));
+        for(int n = 0; n < 40; n++)
+            b.increment_buckets(flow_t(2, 2));
+
+        auto c = a + b;
+
+        auto top = c.top();
+        Assert(top[0].key == flow_t(1, 1));
+        Assert(top[0].count, is_equal_to(50U));
+        Assert(top[1].key == flow_t(2, 2));
+        Assert(top[1].count, is_equal_to(40U));
+    })
+    ;
+
+
+int
+main(int argc, char *argv[])
+{
+    return yats::run(argc,argv);
+}